@@ -8,11 +8,12 @@ Tool    App::tool = Tool::Pixel;
 
 bool App::dragging   = false;
 bool App::plotting   = false;
-bool App::canSave    = true;
-bool App::canLoad    = true;
 bool App::newClick   = false;
 bool App::newRelease = false;
-bool App::canZoom    = true;
+bool App::panning    = false;
+bool App::stroking   = false;
+
+std::vector<CursorSample> App::cursorSamples;
 
 glm::vec2 App::mouse     = glm::vec2(0, 0);
 glm::vec2 App::click     = glm::vec2(0, 0);
@@ -42,9 +43,9 @@ glm::mat4 App::view = glm::lookAt
   , glm::vec3(0, 1, 0)
   );
 
-GLuint App::vaoId;
 
-bool App::dirty = true;
+bool      App::dirty  = true;
+glm::vec4 App::damage = glm::vec4(0.0f);
 GLFWwindow* App::window;
 
 /*
@@ -63,13 +64,89 @@ std::shared_ptr<Button> App::buttonAbout;
 std::shared_ptr<Button> App::buttonSave;
 std::shared_ptr<Button> App::buttonLoad;
 
+/*
+    Keyboard commands, run once per key press
+*/
+const std::map<std::pair<int, int>, std::function<void()>> App::keyActions =
+  { { { GLFW_KEY_ESCAPE, 0 }, []() -> void { glfwSetWindowShouldClose(window, GL_TRUE); } }
+  , { { GLFW_KEY_S, 0 },      []() -> void { Media::SaveCharacter(); } }
+  , { { GLFW_KEY_Z, 0 },      []() -> void { Media::SaveSamples(); } }
+  , { { GLFW_KEY_L, 0 },      []() -> void { Media::LoadCharacter(); } }
+  , { { GLFW_KEY_X, 0 },      []() -> void { Media::LoadSamples(); } }
+  , { { GLFW_KEY_0, 0 },      []() -> void { Character::SetZoom(Character::GetZoom() + 1.0f); } }
+  , { { GLFW_KEY_9, 0 },      []() -> void { Character::SetZoom(Character::GetZoom() - 1.0f); } }
+  , { { GLFW_KEY_F, 0 },      []() -> void { App::SetTool(Tool::Fill); } }
+  , { { GLFW_KEY_B, 0 }
+    , []() -> void
+      {
+        // Canvas, bank and tile in turn
+        Character::SetFillBounds((FillBounds)((Character::GetFillBounds() + 1) % 3));
+      }
+    }
+  , { { GLFW_KEY_RIGHT_BRACKET, 0 }
+    , []() -> void { Character::SetBank(Character::GetBank() + 1); }
+    }
+  , { { GLFW_KEY_LEFT_BRACKET, 0 }
+    , []() -> void { if(Character::GetBank() > 0) Character::SetBank(Character::GetBank() - 1); }
+    }
+  , { { GLFW_KEY_M, 0 },      []() -> void { App::SetTool(Tool::Select); } }
+  , { { GLFW_KEY_T, 0 },      []() -> void { Character::SetTileAligned(!Character::GetTileAligned()); } }
+  , { { GLFW_KEY_DELETE, 0 }, []() -> void { Character::DeleteSelection(); } }
+  , { { GLFW_KEY_H, 0 },             []() -> void { Character::TransformTiles(TileTransform::FlipHorizontal); } }
+  , { { GLFW_KEY_V, 0 },             []() -> void { Character::TransformTiles(TileTransform::FlipVertical); } }
+  , { { GLFW_KEY_R, 0 },             []() -> void { Character::TransformTiles(TileTransform::RotateClockwise); } }
+  , { { GLFW_KEY_R, GLFW_MOD_SHIFT }, []() -> void { Character::TransformTiles(TileTransform::RotateCounterClockwise); } }
+  , { { GLFW_KEY_E, 0 }
+    , []() -> void
+      {
+        // The active entry and the background trade places
+        std::array<GLubyte, 4> entries = { 0, 1, 2, 3 };
+
+        std::swap(entries[0], entries[Samples::GetActiveEntry()]);
+
+        Character::RemapTiles(entries);
+      }
+    }
+  , { { GLFW_KEY_C, GLFW_MOD_CONTROL },                  []() -> void { Character::Copy(); } }
+  , { { GLFW_KEY_X, GLFW_MOD_CONTROL },                  []() -> void { Character::Cut(); } }
+  , { { GLFW_KEY_V, GLFW_MOD_CONTROL },                  []() -> void { Character::Paste(); } }
+  , { { GLFW_KEY_C, GLFW_MOD_SUPER },                    []() -> void { Character::Copy(); } }
+  , { { GLFW_KEY_X, GLFW_MOD_SUPER },                    []() -> void { Character::Cut(); } }
+  , { { GLFW_KEY_V, GLFW_MOD_SUPER },                    []() -> void { Character::Paste(); } }
+  , { { GLFW_KEY_Z, GLFW_MOD_CONTROL },                  []() -> void { History::Undo(); } }
+  , { { GLFW_KEY_Z, GLFW_MOD_CONTROL | GLFW_MOD_SHIFT }, []() -> void { History::Redo(); } }
+  , { { GLFW_KEY_Y, GLFW_MOD_CONTROL },                  []() -> void { History::Redo(); } }
+  , { { GLFW_KEY_Z, GLFW_MOD_SUPER },                    []() -> void { History::Undo(); } }
+  , { { GLFW_KEY_Z, GLFW_MOD_SUPER | GLFW_MOD_SHIFT },   []() -> void { History::Redo(); } }
+  , { { GLFW_KEY_1, 0 }, []() -> void { mode = AppMode::CharacterMode; App::Invalidate(); } }
+  , { { GLFW_KEY_2, 0 }, []() -> void { mode = AppMode::NametableMode; App::Invalidate(); } }
+  , { { GLFW_KEY_3, 0 }, []() -> void { mode = AppMode::AttributeTableMode; App::Invalidate(); } }
+  , { { GLFW_KEY_P, 0 }, []() -> void { Nametable::SetPatternTable(Nametable::GetPatternTable() + 1); } }
+  , { { GLFW_KEY_LEFT, 0 },  []() -> void { Nametable::Scroll(glm::ivec2(-1, 0)); } }
+  , { { GLFW_KEY_RIGHT, 0 }, []() -> void { Nametable::Scroll(glm::ivec2(1, 0)); } }
+  , { { GLFW_KEY_UP, 0 },    []() -> void { Nametable::Scroll(glm::ivec2(0, -1)); } }
+  , { { GLFW_KEY_DOWN, 0 },  []() -> void { Nametable::Scroll(glm::ivec2(0, 1)); } }
+  , { { GLFW_KEY_N, 0 }
+    , []() -> void
+      {
+        // Horizontal, vertical and four screen in turn
+        Nametable::SetMirroring((Mirroring)((Nametable::GetMirroring() + 1) % 3));
+      }
+    }
+  };
+
 AppStatus App::Start()
 {
   const std::vector<const std::function<AppStatus()>> libraryStarters =
     { StartGLFW
     , StartGLEW
     , StartGL
+    , Quad::Start
+    , Frame::Start
+    , Codec::Start
+    , Transform::Start
     , Media::Start
+    , Worker::Start
     };
 
   for(const auto x : libraryStarters)
@@ -92,10 +169,11 @@ AppStatus App::Start()
   buttonLoad      = std::make_shared<Button>();
 
   const std::vector<const std::function<AppStatus()>> entityStarters =
-    { palette->Start
-    , ([]() -> AppStatus { return Samples::Start(palette->GetPaletteTextureId()); })
-    , ([]() -> AppStatus { return Character::Start(palette->GetPaletteTextureId()); })
-    , ([]() -> AppStatus { return Nametable::Start(palette->GetPaletteTextureId()); })
+    { Atlas::Start
+    , palette->Start
+    , samples->Start
+    , character->Start
+    , Nametable::Start
     , ([]() -> AppStatus
         { 
           return buttonPencil->Start
@@ -182,6 +260,7 @@ AppStatus App::Start()
   }
 
   Media::LoadSamples(); // TODO: Default palette should be moved to samples source instead
+  Media::LoadCharacter();
 
   // Start the main loop and eventually return the result
   return Update();
@@ -192,167 +271,67 @@ AppStatus App::Update()
   bool clickConsumed   = false;
   bool releaseConsumed = false;
 
-  const std::vector<const std::function<AppStatus(bool clickConsumed)>> characterModeUpdaters
-    { [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, Palette::GetDrawable()); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, Character::GetDrawable(), true); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, Samples::GetDrawable()); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, buttonPencil->GetDrawable()); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, buttonLine->GetDrawable()); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, buttonRectangle->GetDrawable()); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, buttonEllipse->GetDrawable()); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, buttonAbout->GetDrawable()); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, buttonSave->GetDrawable()); }
-    , [&](bool clickConsumed) -> AppStatus
-        { return UpdateDrawable(&clickConsumed, &releaseConsumed, buttonLoad->GetDrawable()); }
-    };
+  while(!glfwWindowShouldClose(window))
+  {
+    // Pick up finished background saves and loads
+    if(Worker::Poll()) dirty = true;
 
-  const std::vector<const std::function<AppStatus(bool clickConsumed)>> nametableModeUpdaters
-    { // [&](bool clickConsumed) -> AppStatus { return UpdateNametable(&clickConsumed); }
-    // , [&](bool clickConsumed) -> AppStatus { return UpdateCharacter(&clickConsumed); }
-    };
+    Journal::Update();
 
-  const std::vector<const std::function<AppStatus(bool clickConsumed)>> attributeTableModeUpdaters;
-    
-  while( !glfwWindowShouldClose(window)
-      && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS
-       )
-  {
-    // Keyboard input
+    // Update all components
+    if(glfwGetWindowAttrib(window, GLFW_FOCUSED) && (dirty || damage.z > 0.0f))
     {
-      // Process dragging input
-      // I might allow dragging during plotting again at a later stage
-      dragging = !plotting
-              && glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS
-              && App::ScreenToSurface
-                   ( mouse
-                   , character->GetPosition() * Character::GetZoom()
-                   , character->GetSize()
-                   , Character::GetZoom()
-                   ).x != -1;
-
-      // Process save commands
-      if(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-      {
-        if(canSave)
-        {
-          canSave = false;
-          Media::SaveCharacter();
-        }
-      }
-      else if(glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS)
-      {
-        if(canSave)
-        {
-          canSave = false;
-          Media::SaveSamples();
-        }
-      }
-      else
-      {
-        canSave = true;
-      }
+      // A full redraw when state changed, otherwise only what the mouse passed over
+      const auto frustumSizeY = frustumSize.y * aspect;
 
-      // Process load commands
-      if(glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
-      {
-        if(canLoad)
-        {
-          canLoad = false;
-          Media::LoadCharacter();
-        }
+      const auto area = dirty
+        ? glm::vec4(-frustumSize.x, -frustumSizeY, frustumSize.x * 2, frustumSizeY * 2)
+        : damage;
 
-        dirty = true;
-      }
-      else if(glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS)
-      {                
-        if(canLoad)
-        {
-          canLoad = false;
-          Media::LoadSamples();
-        }
+      clickConsumed   = !newClick;
+      releaseConsumed = !newRelease;
 
-        dirty = true;
-      }
-      else
-      {
-        canLoad = true;
-      }
+      // Clicks below may invalidate again, that is drawn on the next frame
+      dirty  = false;
+      damage = glm::vec4(0.0f);
 
-      // Process mode switch command
-      // if(glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
-      // {
-      //   mode  = AppMode::CharacterMode;
-      //   dirty = true;
-      // }
-      // else if(glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
-      // {
-      //   mode  = AppMode::NametableMode;
-      //   dirty = true;
-      // }
-      // else if(glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
-      // {
-      //   mode  = AppMode::AttributeTableMode;
-      //   dirty = true;
-      // }
-
-      // Process zooming commands
-      if(glfwGetKey(window, GLFW_KEY_0) == GLFW_PRESS)
-      {
-        if(canZoom)
-        {
-          Character::SetZoom(Character::GetZoom() + 1.0f);
+      // The pencil follows every cursor sample since the last frame, not only where the
+      // cursor is now. A stroke that ended may be followed by the next one in the same frame
+      const View<const CursorSample> samples(cursorSamples);
 
-          canZoom = false;
-          dirty   = true;
-        }
-      }
-      else if(glfwGetKey(window, GLFW_KEY_9) == GLFW_PRESS)
-      {
-        if(canZoom)
-        {
-          Character::SetZoom(Character::GetZoom() - 1.0f);
+      size_t first = 0;
 
-          canZoom = false;
-          dirty   = true;
-        }
-      }
-      else
+      for(size_t i = 0; i < samples.size(); i++)
       {
-        canZoom = true;
+        if(!samples[i].last) continue;
+
+        Character::Stroke(samples.Slice(first, i + 1 - first));
+        Character::EndStroke();
+
+        first = i + 1;
       }
-    }
 
-    // Update all components
-    if(glfwGetWindowAttrib(window, GLFW_FOCUSED) && dirty)
-    {
-      dirty = false;
+      if(first < samples.size()) Character::Stroke(samples.Slice(first, samples.size() - first));
 
-      clickConsumed   = !newClick;
-      releaseConsumed = !newRelease;
-            
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      cursorSamples.clear();
 
-      std::vector<const std::function<AppStatus(bool clickConsumed)>> updaters
-        = mode == AppMode::CharacterMode ? characterModeUpdaters
-        : mode == AppMode::NametableMode ? nametableModeUpdaters 
-        : attributeTableModeUpdaters;
+      Frame::Begin(AreaToPixels(area));
 
-      for(const auto x : updaters)
+      for(const auto& x : GetDrawables())
       {
-        const auto result = x(clickConsumed);
+        // Every drawable under the mouse sees the click, the release goes to the first one
+        auto clicked = clickConsumed;
+
+        const auto result = UpdateDrawable(&clicked, &releaseConsumed, x, area);
         if(result != AppStatus::Success) return result;
       }
 
+      // Buttons and other batched quads go out in a few instanced draws
+      Quad::Flush(projection * view);
+
       newRelease = false;
+
+      Frame::End();
             
       glfwSwapBuffers(window);
 
@@ -377,7 +356,15 @@ AppStatus App::Update()
 #endif
     }
 
-    glfwPollEvents();
+    // Sleep until input arrives, the worker posts an empty event when a job finishes
+    // and the journal is woken up for its next flush
+    const auto timeout = Journal::GetTimeout();
+
+    const auto pending = dirty || damage.z > 0.0f;
+
+    if(pending && glfwGetWindowAttrib(window, GLFW_FOCUSED)) glfwPollEvents();
+    else if(timeout < 0.0)                                    glfwWaitEvents();
+    else                                                      glfwWaitEventsTimeout(timeout);
   }
 
   // Terminate the application and return the result
@@ -388,14 +375,14 @@ AppStatus App::UpdateDrawable
   ( bool* clickConsumed
   , bool* releaseConsumed
   , std::shared_ptr<IDrawable> drawable
-  , bool zoomable
+  , glm::vec4 area
   )
 {    
   const auto m = App::ScreenToSurface
     ( mouse
-    , drawable->GetPosition() * (zoomable ? Character::GetZoom() : 1.0f)
+    , drawable->GetPosition() * drawable->GetZoom()
     , drawable->GetSize()
-    , zoomable ? Character::GetZoom() : 1.0f
+    , drawable->GetZoom()
     );
 
   // TODO: Fix clicking logic, I can't switch between tools using the buttons right now
@@ -410,10 +397,74 @@ AppStatus App::UpdateDrawable
     drawable->Release(m);
     *releaseConsumed = true;
   }
+
+  // Drawables outside the scissor would not change a single pixel
+  if(!Overlaps(drawable->GetBounds(), area)) return AppStatus::Success;
   
   return drawable->Draw(projection, view, m);
 }
 
+std::vector<std::shared_ptr<IDrawable>> App::GetDrawables()
+{
+  if(mode != AppMode::CharacterMode) return { Nametable::GetDrawable() };
+
+  return
+    { Palette::GetDrawable()
+    , Character::GetDrawable()
+    , Samples::GetDrawable()
+    , buttonPencil->GetDrawable()
+    , buttonLine->GetDrawable()
+    , buttonRectangle->GetDrawable()
+    , buttonEllipse->GetDrawable()
+    , buttonAbout->GetDrawable()
+    , buttonSave->GetDrawable()
+    , buttonLoad->GetDrawable()
+    };
+}
+
+void App::Damage(glm::vec4 area)
+{
+  if(area.z <= 0.0f || area.w <= 0.0f) return;
+
+  if(damage.z <= 0.0f)
+  {
+    damage = area;
+    return;
+  }
+
+  const auto first = glm::min(glm::vec2(damage), glm::vec2(area));
+  const auto last  = glm::max
+    ( glm::vec2(damage.x + damage.z, damage.y + damage.w)
+    , glm::vec2(area.x + area.z, area.y + area.w)
+    );
+
+  damage = glm::vec4(first, last - first);
+}
+
+bool App::Overlaps(glm::vec4 a, glm::vec4 b)
+{
+  return a.x < b.x + b.z && b.x < a.x + a.z
+      && a.y < b.y + b.w && b.y < a.y + a.w;
+}
+
+glm::ivec4 App::AreaToPixels(glm::vec4 area)
+{
+  const auto frame        = glm::vec2(Frame::GetSize());
+  const auto frustumSizeY = frustumSize.y * aspect;
+
+  // The mouse space grows downwards, pixels grow upwards from the bottom left
+  const auto left   = (area.x + frustumSize.x) / (frustumSize.x * 2) * frame.x;
+  const auto right  = (area.x + area.z + frustumSize.x) / (frustumSize.x * 2) * frame.x;
+  const auto top    = (1.0f - (area.y + frustumSizeY) / (frustumSizeY * 2)) * frame.y;
+  const auto bottom = (1.0f - (area.y + area.w + frustumSizeY) / (frustumSizeY * 2)) * frame.y;
+
+  // A pixel of margin covers rounding at the edges of the surfaces
+  const auto first = glm::max(glm::ivec2(floor(left) - 1, floor(bottom) - 1), glm::ivec2(0));
+  const auto last  = glm::min(glm::ivec2(ceil(right) + 1, ceil(top) + 1), Frame::GetSize());
+
+  return glm::ivec4(first, glm::max(last - first, glm::ivec2(0)));
+}
+
 AppStatus App::StartGLFW()
 {
   if(!glfwInit())
@@ -444,10 +495,13 @@ AppStatus App::StartGLFW()
     
   glfwMakeContextCurrent(window);
 
-  glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
+  glfwSetKeyCallback(window, App::GLFWKeyCallback);
   glfwSetCursorPosCallback(window, App::GLFWCursorPositionCallback);
   glfwSetMouseButtonCallback(window, App::GLFWMouseButtonCallback);
   glfwSetScrollCallback(window, App::GLFWScrollCallback);
+  glfwSetWindowFocusCallback(window, App::GLFWWindowFocusCallback);
+  glfwSetWindowRefreshCallback(window, App::GLFWWindowRefreshCallback);
+  glfwSetFramebufferSizeCallback(window, App::GLFWFramebufferSizeCallback);
   
   return AppStatus::Success;
 }
@@ -468,9 +522,6 @@ AppStatus App::StartGL()
   glEnable(GL_DEPTH_TEST);
   glDepthFunc(GL_LESS);
 
-  glGenVertexArrays(1, &vaoId);
-  glBindVertexArray(vaoId);
-
   return AppStatus::Success;
 }
 
@@ -479,11 +530,16 @@ AppStatus App::Stop()
   // TODO: Check if libraries like DevIL need to be destroyed as well
 
   const std::vector<const std::function<AppStatus()>> stoppers
-    { Media::Stop
+    { Journal::Stop
+    , Worker::Stop
+    , Media::Stop
     , Palette::Stop
     , Samples::Stop
     , Character::Stop
     , Nametable::Stop
+    , Atlas::Stop
+    , Frame::Stop
+    , Quad::Stop
     };
 
   for(const auto x : stoppers)
@@ -492,9 +548,6 @@ AppStatus App::Stop()
     if(result != AppStatus::Success) return result;
   }
 
-  const GLuint vaoIds[] { vaoId };
-
-  glDeleteVertexArrays(1, vaoIds);
   glfwTerminate();
   
   return AppStatus::Success;
@@ -552,8 +605,16 @@ bool App::GetPlotting()
   return plotting;
 }
 
+void App::Invalidate()
+{
+  dirty = true;
+}
+
 void App::SetTool(Tool t)
 {
+  // The buttons show the active tool
+  if(tool != t) dirty = true;
+
   tool = t;
 }
 
@@ -577,10 +638,22 @@ void App::GLFWCursorPositionCallback(GLFWwindow* window, double mX, double mY)
     , mouseY * frustumSizeY  * 2 - frustumSizeY
     );
 
+  // I might allow dragging during plotting again at a later stage
+  dragging = panning
+          && !plotting
+          && App::ScreenToSurface
+               ( mouse
+               , character->GetPosition() * Character::GetZoom()
+               , character->GetSize()
+               , Character::GetZoom()
+               ).x != -1;
+
   if(dragging)
   {
     const auto displacement = newMouse - glm::vec2(mouse.x, mouse.y);
 
+    dirty = true;
+
     if(mode == AppMode::CharacterMode)
     {
       character->Move(displacement);
@@ -595,7 +668,10 @@ void App::GLFWCursorPositionCallback(GLFWwindow* window, double mX, double mY)
     }
   }
 
-  dirty = true;
+  if(stroking) cursorSamples.push_back({ newMouse, glfwGetTime(), false });
+
+  for(const auto& x : GetDrawables()) Damage(x->GetDamage(mouse, newMouse));
+
   mouse = newMouse;
 }
 
@@ -611,11 +687,20 @@ void App::GLFWMouseButtonCallback(GLFWwindow* window, int button, int action, in
 
       switch(tool)
       {
+      case Tool::Pixel:
+          // The stroke starts with a dot where the button went down
+          stroking = App::mode == AppMode::CharacterMode;
+
+          if(stroking) cursorSamples.push_back({ mouse, glfwGetTime(), false });
+          break;
+
       case Tool::Line:
       case Tool::RectangleFrame:
       case Tool::RectangleFill:
+      case Tool::RectangleCheckerboard:
       case Tool::EllipseFrame:
       case Tool::EllipseFill:
+      case Tool::Select:
           plotStart = click;
           plotting = true;
           break;
@@ -629,6 +714,11 @@ void App::GLFWMouseButtonCallback(GLFWwindow* window, int button, int action, in
       newClick   = false;
       newRelease = true;
       plotting   = false;
+
+      // Motion after this belongs to no stroke, even before the next frame
+      if(stroking) cursorSamples.push_back({ mouse, glfwGetTime(), true });
+
+      stroking = false;
     }
   }
 
@@ -644,13 +734,51 @@ void App::GLFWScrollCallback(GLFWwindow* window, double offsetX, double offsetY)
     character->Zoom(offsetY);
     dirty = true;
   }
-  else if(AppMode::NametableMode)
+  else
   {
     nametable->Zoom(offsetY);
     dirty = true;
   }
-  // else if(AppMode::AttributeTableMode)
-  // {
+}
+
+void App::GLFWKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+  // Dragging follows the key for as long as it is held
+  if(key == GLFW_KEY_SPACE)
+  {
+    panning = action != GLFW_RELEASE;
+    return;
+  }
+
+  // Held keys repeat, commands only run on the first press
+  if(action != GLFW_PRESS) return;
 
-  // }
+  // Lock keys don't change what a shortcut means
+  const auto modifiers = mods & (GLFW_MOD_SHIFT | GLFW_MOD_CONTROL | GLFW_MOD_ALT | GLFW_MOD_SUPER);
+
+  const auto x = keyActions.find({ key, modifiers });
+  if(x == keyActions.end()) return;
+
+  x->second();
+
+  dirty = true;
+}
+
+void App::GLFWWindowFocusCallback(GLFWwindow* window, int focused)
+{
+  // Frames are skipped without focus, whatever changed meanwhile is drawn now
+  if(focused) dirty = true;
+}
+
+void App::GLFWWindowRefreshCallback(GLFWwindow* window)
+{
+  dirty = true;
+}
+
+void App::GLFWFramebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+  const auto result = Frame::Resize(glm::ivec2(width, height));
+  if(result != AppStatus::Success) Debug::LogStatus(result);
+
+  dirty = true;
 }
@@ -6,6 +6,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <string>
+#include <map>
+#include <functional>
 #include <math.h>
 
 #include "appstatus.h"
@@ -19,7 +21,11 @@
 #include "character.h"
 #include "nametable.h"
 #include "button.h"
+#include "quad.h"
+#include "frame.h"
+#include "atlas.h"
 #include "idrawable.h"
+#include "cursorsample.h"
 
 class Palette;
 class Samples;
@@ -41,6 +47,7 @@ public:
   static glm::vec2 GetFrustumSize();
 
   static void SetTool(Tool t);
+  static void Invalidate();
 
   static glm::vec2 ScreenToSurface
     ( glm::vec2 point
@@ -61,8 +68,14 @@ private:
     ( bool* clickConsumed
     , bool* releaseConsumed
     , std::shared_ptr<IDrawable> drawable
-    , bool zoomable = false
+    , glm::vec4 area
     );
+
+  static std::vector<std::shared_ptr<IDrawable>> GetDrawables();
+
+  static void       Damage(glm::vec4 area);
+  static bool       Overlaps(glm::vec4 a, glm::vec4 b);
+  static glm::ivec4 AreaToPixels(glm::vec4 area);
     
   static void GLFWCursorPositionCallback
     ( GLFWwindow* window
@@ -82,20 +95,35 @@ private:
     , double offsetX
     , double offsetY
     );
+
+  static void GLFWKeyCallback
+    ( GLFWwindow* window
+    , int key
+    , int scancode
+    , int action
+    , int mods
+    );
+
+  static void GLFWWindowFocusCallback(GLFWwindow* window, int focused);
+  static void GLFWWindowRefreshCallback(GLFWwindow* window);
+  static void GLFWFramebufferSizeCallback(GLFWwindow* window, int width, int height);
     
   static const std::string CAPTION;
 
+  static const std::map<std::pair<int, int>, std::function<void()>> keyActions;
+
   static AppMode         mode;
   static InteractionMode interactionMode;
     
   static Tool tool;
   static bool dragging;
   static bool plotting;
-  static bool canSave;
-  static bool canLoad;
   static bool newClick;
   static bool newRelease;
-  static bool canZoom;
+  static bool panning;
+  static bool stroking;
+
+  static std::vector<CursorSample> cursorSamples;
     
   static glm::vec2 mouse;
   static glm::vec2 click;
@@ -107,7 +135,6 @@ private:
   static glm::mat4 view;
   static GLfloat   aspect;
     
-  static GLuint vaoId;
 
   static std::unique_ptr<Palette>   palette;
   static std::unique_ptr<Samples>   samples;
@@ -122,7 +149,8 @@ private:
   static std::shared_ptr<Button> buttonSave;
   static std::shared_ptr<Button> buttonLoad;
   
-  static bool dirty;
+  static bool      dirty;
+  static glm::vec4 damage;
   static GLFWwindow* window;
 };
 
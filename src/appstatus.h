@@ -11,6 +11,11 @@ enum AppStatus
   FailureSampleSet,
   FailureTextureLoad,
   FailureDevILStart,
+  FailureRomHeader,
+  FailureCharacterSave,
+  FailureCharacterLoad,
+  FailureFramebuffer,
+  FailureMapLoad,
   Success
 };
 
@@ -0,0 +1,106 @@
+#include "atlas.h"
+
+#include <algorithm>
+
+const std::vector<std::string> Atlas::icons =
+  { "tool_pencil"
+  , "tool_line"
+  , "tool_rectangle"
+  , "tool_ellipse"
+  , "about"
+  , "save"
+  , "load"
+  };
+
+std::vector<glm::vec4> Atlas::rects;
+
+GLuint Atlas::textureId = 0;
+
+AppStatus Atlas::Start()
+{
+  std::vector<Image> images;
+
+  GLuint width  = 0;
+  GLuint height = 0;
+
+  for(const auto& icon : icons)
+  {
+    auto result = Media::LoadImage("../assets/" + icon + ".png");
+    if(result.first != AppStatus::Success) return result.first;
+
+    width += result.second.width;
+    height = std::max(height, result.second.height);
+
+    images.push_back(std::move(result.second));
+  }
+
+  std::vector<GLubyte> pixels(width * height * 4, 0);
+
+  GLuint x = 0;
+
+  rects.clear();
+
+  for(const auto& image : images)
+  {
+    for(GLuint row = 0; row < image.height; row++)
+    {
+      std::copy
+        ( image.rgba.begin() + row * image.width * 4
+        , image.rgba.begin() + (row + 1) * image.width * 4
+        , pixels.begin() + (row * width + x) * 4
+        );
+    }
+
+    rects.push_back
+      ( glm::vec4
+          ( (GLfloat)x / width
+          , 0.0f
+          , (GLfloat)image.width / width
+          , (GLfloat)image.height / height
+          )
+      );
+
+    x += image.width;
+  }
+
+  glGenTextures(1, &textureId);
+  glBindTexture(GL_TEXTURE_2D, textureId);
+
+  glTexImage2D
+    ( GL_TEXTURE_2D, 0, GL_RGBA, width, height
+    , 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()
+    );
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  return AppStatus::Success;
+}
+
+AppStatus Atlas::Stop()
+{
+  GLuint textureIds[] = { textureId };
+
+  glDeleteTextures(1, textureIds);
+
+  return AppStatus::Success;
+}
+
+GLuint Atlas::GetTextureId()
+{
+  return textureId;
+}
+
+std::pair<AppStatus, glm::vec4> Atlas::GetRect(std::string icon)
+{
+  const auto found = std::find(icons.begin(), icons.end(), icon);
+
+  if(found == icons.end())
+  {
+    Debug::Log(LogLevel::Error, "No icon called " + icon + " in the atlas");
+    return std::make_pair(AppStatus::FailureTextureLoad, glm::vec4(0.0f));
+  }
+
+  return std::make_pair(AppStatus::Success, rects[found - icons.begin()]);
+}
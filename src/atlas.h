@@ -0,0 +1,39 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "appstatus.h"
+#include "debug.h"
+#include "media.h"
+
+/*
+  All button icons in one texture, packed at startup from the separate icon
+  images in assets/ and uploaded once.
+
+  The icons are placed left to right in the order of the icon list, each
+  along the bottom of the atlas.
+*/
+class Atlas
+{
+public:
+  static AppStatus Start();
+  static AppStatus Stop();
+
+  static GLuint GetTextureId();
+
+  static std::pair<AppStatus, glm::vec4> GetRect(std::string icon);
+
+private:
+  static const std::vector<std::string> icons;
+
+  static std::vector<glm::vec4> rects;
+
+  static GLuint textureId;
+};
+
+#endif
@@ -0,0 +1,257 @@
+#include "bankstore.h"
+
+#include <cstring>
+#include <algorithm>
+
+void BankStore::Reset(std::shared_ptr<const GLubyte> planar, size_t tiles, size_t minimumBanks)
+{
+  source      = planar;
+  sourceTiles = planar ? tiles : 0;
+
+  const auto count = std::max((sourceTiles + BANK_TILES - 1) / BANK_TILES, minimumBanks);
+
+  banks.clear();
+  banks.resize(count);
+
+  dirty.assign((count * BANK_TILES + 63) / 64, 0);
+}
+
+const GLubyte* BankStore::GetBank(size_t bank)
+{
+  if(bank >= banks.size()) return nullptr;
+
+  auto& b = banks[bank];
+
+  if(!b.planar)
+  {
+    std::shared_ptr<GLubyte> planar(new GLubyte[BANK_BYTES], std::default_delete<GLubyte[]>());
+
+    ReadTiles(bank * BANK_TILES, BANK_TILES, planar.get());
+
+    b.planar = planar;
+    b.edited = false;
+  }
+
+  return b.planar.get();
+}
+
+BankSnapshot BankStore::GetSnapshot()
+{
+  BankSnapshot snapshot;
+
+  snapshot.banks.reserve(banks.size());
+
+  for(size_t i = 0; i < banks.size(); i++)
+  {
+    size_t tiles;
+    const auto source = GetSource(i, &tiles);
+
+    // Untouched banks point straight into the source
+    if(!banks[i].planar && tiles == BANK_TILES)
+    {
+      snapshot.banks.push_back(std::shared_ptr<const GLubyte>(this->source, source));
+    }
+    else
+    {
+      GetBank(i);
+      snapshot.banks.push_back(banks[i].planar);
+    }
+  }
+
+  return snapshot;
+}
+
+void BankStore::GetTile(size_t tile, GLubyte* planar) const
+{
+  ReadTiles(tile, 1, planar);
+}
+
+void BankStore::SetTile(size_t tile, const GLubyte* planar)
+{
+  const auto data = GetWritableBank(tile / BANK_TILES);
+  if(data == nullptr) return;
+
+  memcpy(data + (tile % BANK_TILES) * Codec::TILE_BYTES, planar, Codec::TILE_BYTES);
+
+  MarkDirty(tile);
+}
+
+GLubyte BankStore::GetPixel(size_t tile, size_t x, size_t y)
+{
+  const auto data = GetBank(tile / BANK_TILES);
+  if(data == nullptr) return 0;
+
+  const auto row = data + (tile % BANK_TILES) * Codec::TILE_BYTES + y;
+  const auto bit = 7 - x;
+
+  return ((row[0] >> bit) & 1) | (((row[8] >> bit) & 1) << 1);
+}
+
+void BankStore::SetPixel(size_t tile, size_t x, size_t y, GLubyte color)
+{
+  const auto data = GetWritableBank(tile / BANK_TILES);
+  if(data == nullptr) return;
+
+  const auto row  = data + (tile % BANK_TILES) * Codec::TILE_BYTES + y;
+  const auto mask = (GLubyte)(0x80 >> x);
+
+  row[0] = (color & 1) ? row[0] | mask : row[0] & ~mask;
+  row[8] = (color & 2) ? row[8] | mask : row[8] & ~mask;
+
+  MarkDirty(tile);
+}
+
+void BankStore::MarkDirty(size_t tile)
+{
+  const auto bank = tile / BANK_TILES;
+
+  if(bank >= banks.size()) return;
+
+  // Edited banks stay resident even after saving
+  banks[bank].edited = true;
+
+  dirty[tile / 64] |= (uint64_t)1 << (tile % 64);
+}
+
+void BankStore::ClearDirty()
+{
+  std::fill(dirty.begin(), dirty.end(), 0);
+}
+
+void BankStore::Trim(size_t first, size_t count)
+{
+  for(size_t i = 0; i < banks.size(); i++)
+  {
+    auto& b = banks[i];
+
+    if(b.planar && !b.edited && (i < first || i >= first + count))
+    {
+      b.planar.reset();
+    }
+  }
+}
+
+void BankStore::ReadTiles(size_t first, size_t count, GLubyte* planar) const
+{
+  while(count > 0)
+  {
+    const auto bank   = first / BANK_TILES;
+    const auto offset = first % BANK_TILES;
+    const auto tiles  = std::min(count, BANK_TILES - offset);
+    const auto length = tiles * Codec::TILE_BYTES;
+
+    if(banks[bank].planar)
+    {
+      memcpy(planar, banks[bank].planar.get() + offset * Codec::TILE_BYTES, length);
+    }
+    else
+    {
+      // Banks that were never accessed are copied straight from the source
+      size_t available;
+      const auto source = GetSource(bank, &available);
+
+      const auto copied = offset < available
+        ? std::min(available - offset, tiles) * Codec::TILE_BYTES
+        : 0;
+
+      if(copied > 0) memcpy(planar, source + offset * Codec::TILE_BYTES, copied);
+      memset(planar + copied, 0, length - copied);
+    }
+
+    first  += tiles;
+    count  -= tiles;
+    planar += length;
+  }
+}
+
+std::vector<std::pair<size_t, size_t>> BankStore::GetDirtyRuns() const
+{
+  std::vector<std::pair<size_t, size_t>> runs;
+
+  for(size_t word = 0; word < dirty.size(); word++)
+  {
+    auto bits = dirty[word];
+
+    while(bits != 0)
+    {
+      const auto tile = word * 64 + __builtin_ctzll(bits);
+
+      bits &= bits - 1;
+
+      if(!runs.empty() && runs.back().first + runs.back().second == tile)
+      {
+        runs.back().second++;
+      }
+      else
+      {
+        runs.push_back(std::make_pair(tile, (size_t)1));
+      }
+    }
+  }
+
+  return runs;
+}
+
+size_t BankStore::GetBankCount() const
+{
+  return banks.size();
+}
+
+size_t BankStore::GetTileCount() const
+{
+  return banks.size() * BANK_TILES;
+}
+
+size_t BankStore::GetResidentCount() const
+{
+  return std::count_if
+    ( banks.begin()
+    , banks.end()
+    , [](const Bank& b) -> bool { return b.planar != nullptr; }
+    );
+}
+
+GLubyte* BankStore::GetWritableBank(size_t bank)
+{
+  if(GetBank(bank) == nullptr) return nullptr;
+
+  auto& b = banks[bank];
+
+  // Snapshots keep the contents they were taken with
+  if(b.planar.use_count() > 1)
+  {
+    std::shared_ptr<GLubyte> planar(new GLubyte[BANK_BYTES], std::default_delete<GLubyte[]>());
+
+    memcpy(planar.get(), b.planar.get(), BANK_BYTES);
+
+    b.planar = planar;
+  }
+
+  return b.planar.get();
+}
+
+const GLubyte* BankStore::GetSource(size_t bank, size_t* tiles) const
+{
+  const auto first = bank * BANK_TILES;
+
+  *tiles = first < sourceTiles ? std::min(sourceTiles - first, BANK_TILES) : 0;
+
+  return *tiles > 0 ? source.get() + first * Codec::TILE_BYTES : nullptr;
+}
+
+View<const GLubyte> BankSnapshot::GetTiles(size_t first, size_t count) const
+{
+  const auto bank   = first / BankStore::BANK_TILES;
+  const auto offset = first % BankStore::BANK_TILES;
+
+  if(bank >= banks.size()) return View<const GLubyte>();
+
+  const auto tiles = std::min(count, BankStore::BANK_TILES - offset);
+
+  return View<const GLubyte>(banks[bank].get() + offset * Codec::TILE_BYTES, tiles * Codec::TILE_BYTES);
+}
+
+size_t BankSnapshot::GetTileCount() const
+{
+  return banks.size() * BankStore::BANK_TILES;
+}
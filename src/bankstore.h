@@ -0,0 +1,91 @@
+#ifndef BANKSTORE_H
+#define BANKSTORE_H
+
+#include <GL/glew.h>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
+
+#include "codec.h"
+#include "view.h"
+
+class BankStore;
+
+/*
+  Read-only state of all banks at one point in time, for savers that run
+  after the frame that took it. Banks are shared with the store until they
+  are edited, so taking a snapshot copies no tile data.
+*/
+class BankSnapshot
+{
+public:
+  // A range that crosses into the next bank is cut at the end of the first
+  View<const GLubyte> GetTiles(size_t first, size_t count) const;
+
+  size_t GetTileCount() const;
+
+private:
+  friend class BankStore;
+
+  std::vector<std::shared_ptr<const GLubyte>> banks;
+};
+
+/*
+  Character data split into banks of 256 tiles.
+
+  Tiles stay in their planar form throughout. The source (usually a file
+  mapping) is kept as is, and a bank is only copied out of it when it is
+  first accessed. Banks that were not edited can be dropped again once they
+  leave the view.
+
+  Edited tiles are tracked individually until the next save. A bank that is
+  still part of a snapshot is copied before its first edit.
+*/
+class BankStore
+{
+public:
+  static constexpr size_t BANK_TILES = 256;
+  static constexpr size_t BANK_WIDTH = 128;
+  static constexpr size_t BANK_BYTES = BANK_TILES * Codec::TILE_BYTES;
+
+  void Reset(std::shared_ptr<const GLubyte> planar, size_t tiles, size_t minimumBanks);
+
+  const GLubyte* GetBank(size_t bank);
+
+  BankSnapshot GetSnapshot();
+
+  void GetTile(size_t tile, GLubyte* planar) const;
+  void SetTile(size_t tile, const GLubyte* planar);
+
+  GLubyte GetPixel(size_t tile, size_t x, size_t y);
+  void    SetPixel(size_t tile, size_t x, size_t y, GLubyte color);
+
+  void MarkDirty(size_t tile);
+  void ClearDirty();
+  void Trim(size_t first, size_t count);
+  void ReadTiles(size_t first, size_t count, GLubyte* planar) const;
+
+  std::vector<std::pair<size_t, size_t>> GetDirtyRuns() const;
+
+  size_t GetBankCount() const;
+  size_t GetTileCount() const;
+  size_t GetResidentCount() const;
+
+private:
+  struct Bank
+  {
+    std::shared_ptr<GLubyte> planar;
+    bool edited;
+  };
+
+  GLubyte*       GetWritableBank(size_t bank);
+  const GLubyte* GetSource(size_t bank, size_t* tiles) const;
+
+  std::shared_ptr<const GLubyte> source;
+  size_t                         sourceTiles;
+  std::vector<Bank>              banks;
+  std::vector<uint64_t>          dirty;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "blit.h"
+
+void Blit::PackRow
+  ( const GLubyte* const* banks
+  , size_t banksCount
+  , size_t y
+  , uint64_t* low
+  , uint64_t* high
+  )
+{
+  // Eight tile bytes side by side make a word
+  for(size_t side = 0; side < banksCount; side++)
+  {
+    for(size_t column = 0; column < BANK_COLUMNS; column++)
+    {
+      const auto word  = (side * BANK_COLUMNS + column) / 8;
+      const auto shift = 56 - 8 * (column % 8);
+
+      if(column % 8 == 0)
+      {
+        low[word]  = 0;
+        high[word] = 0;
+      }
+
+      if(banks[side] == nullptr) continue;
+
+      const auto row = banks[side] + ((y / 8) * BANK_COLUMNS + column) * Codec::TILE_BYTES + y % 8;
+
+      low[word]  |= (uint64_t)row[0] << shift;
+      high[word] |= (uint64_t)row[8] << shift;
+    }
+  }
+}
+
+GLubyte Blit::RowByte(const uint64_t* row, size_t column)
+{
+  return (GLubyte)(row[column / 8] >> (56 - 8 * (column % 8)));
+}
+
+void Blit::Extract(const uint64_t* row, int x, int width, uint64_t* out)
+{
+  // The row needs one readable word past the last pixel taken
+  for(int i = 0; i * 64 < width; i++)
+  {
+    const auto p     = x + i * 64;
+    const auto word  = p / 64;
+    const auto shift = p % 64;
+
+    auto value = row[word] << shift;
+
+    if(shift != 0) value |= row[word + 1] >> (64 - shift);
+
+    out[i] = value & Leading(std::min(64, width - i * 64));
+  }
+}
+
+void Blit::Insert(uint64_t* row, int x, int width, const uint64_t* in)
+{
+  for(int i = 0; i * 64 < width; i++)
+  {
+    const auto p     = x + i * 64;
+    const auto word  = p / 64;
+    const auto shift = p % 64;
+    const auto count = std::min(64, width - i * 64);
+    const auto mask  = Leading(count);
+    const auto value = in[i] & mask;
+
+    row[word] = (row[word] & ~(mask >> shift)) | (value >> shift);
+
+    // The run straddles two words
+    if(shift + count > 64)
+    {
+      row[word + 1] = (row[word + 1] & ~(mask << (64 - shift))) | (value << (64 - shift));
+    }
+  }
+}
+
+void Blit::Clear(uint64_t* row, int x, int width)
+{
+  const uint64_t zero[] = { 0 };
+
+  for(int i = 0; i * 64 < width; i++)
+  {
+    Insert(row, x + i * 64, std::min(64, width - i * 64), zero);
+  }
+}
+
+uint64_t Blit::Leading(int count)
+{
+  return count >= 64 ? ~(uint64_t)0 : ~(~(uint64_t)0 >> count);
+}
@@ -0,0 +1,69 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "codec.h"
+
+/*
+  Rectangle of pixels kept as two packed bitplanes, 64 pixels per word
+  with the leftmost pixel in the highest bit, like the tile bytes.
+*/
+struct PlanarImage
+{
+  glm::ivec2            size   = glm::ivec2(0);
+  size_t                stride = 0; // Words per row
+  std::vector<uint64_t> low;
+  std::vector<uint64_t> high;
+
+  void Reset(glm::ivec2 newSize)
+  {
+    size   = newSize;
+    stride = (size.x + 63) / 64;
+
+    // One word of padding lets the last row be read at any offset
+    low.assign(stride * size.y + 1, 0);
+    high.assign(stride * size.y + 1, 0);
+  }
+
+  bool Empty() const
+  {
+    return size.x <= 0 || size.y <= 0;
+  }
+};
+
+/*
+  Bit blits on packed rows.
+
+  A row of tiles is packed into words once, after that copying, clearing
+  and moving any run of pixels is a few shifts and masks per 64 pixels
+  whatever the offset, and the result goes back one tile byte at a time.
+*/
+class Blit
+{
+public:
+  static void PackRow
+    ( const GLubyte* const* banks
+    , size_t banksCount
+    , size_t y
+    , uint64_t* low
+    , uint64_t* high
+    );
+
+  static GLubyte RowByte(const uint64_t* row, size_t column);
+
+  static void Extract(const uint64_t* row, int x, int width, uint64_t* out);
+  static void Insert(uint64_t* row, int x, int width, const uint64_t* in);
+  static void Clear(uint64_t* row, int x, int width);
+
+private:
+  static uint64_t Leading(int count);
+
+  static constexpr size_t BANK_COLUMNS = 16;
+};
+
+#endif
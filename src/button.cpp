@@ -28,29 +28,6 @@ AppStatus Button::Start
     , -0.5f
     );
 
-  model = glm::translate(glm::mat4(1.0f), position);
-
-  vertices =
-    { -size.x / 2, size.y / 2, 1.0f
-    , 0.0f, 0.0f
-    , size.x / 2, size.y / 2, 1.0f
-    , 1.0, 0.0f
-    , size.x / 2, -size.y / 2, 1.0f
-    , 1.0f, 1.0f
-    , -size.x / 2, -size.y / 2, 1.0f
-    , 0.0f, 1.0f
-    };
-
-  indices = { 0, 1, 2, 2, 3, 0 };
-
-  glGenBuffers(1, &vertexBufferId);
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-  
-  glGenBuffers(1, &indexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
-
   std::vector<std::string> filenames = { "button.vert", "button.frag" };
     
   const auto programResult = Media::LoadShaderProgram(filenames);
@@ -60,21 +37,16 @@ AppStatus Button::Start
   }
     
   programId = programResult.second;
-  
-  mvpUniformId        = glGetUniformLocation(programId, "mvp");
-  mouseUniformId      = glGetUniformLocation(programId, "mouse");
-  activeSideUniformId = glGetUniformLocation(programId, "activeSide");
-  isTwoSidedUniformId = glGetUniformLocation(programId, "isTwoSided");
 
   {
-    const auto result = Media::LoadTexture("../assets/" + which + ".png");
+    const auto result = Atlas::GetRect(which);
     if(result.first != AppStatus::Success)
     {
       return result.first;
     }
     else
     {
-      textureId = result.second;
+      iconRect = result.second;
     }
   }
 
@@ -83,48 +55,20 @@ AppStatus Button::Start
   return AppStatus::Success;
 }
 
-Button::~Button()
-{
-  GLuint textureIds[] = { textureId };
-  GLuint bufferIds[] = { vertexBufferId, indexBufferId };
-  
-  glDeleteBuffers(2, bufferIds);
-  glDeleteProgram(programId);
-  glDeleteTextures(1, textureIds);
-}
-
 AppStatus Button::Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse)
 {
-  const auto mvp = projection * view * model;
+  QuadInstance instance;
 
   mouse.y = 1.0f - mouse.y;
-  
-  glUseProgram(programId);
 
-  glUniformMatrix4fv(mvpUniformId, 1, GL_FALSE, &mvp[0][0]);
-  glUniform2fv(mouseUniformId, 1, &mouse[0]);
-  glUniform1ui(activeSideUniformId, activeSide());
-  glUniform1ui(isTwoSidedUniformId, actionBottomRight != nullptr ? 1 : 0);
+  instance.rect   = glm::vec4(position.x, position.y, size.x, size.y);
+  instance.uvRect = iconRect;
+  instance.mouse  = mouse;
+  instance.depth  = position.z + 1.0f;
+  instance.flags  = activeSide() | (actionBottomRight != nullptr ? 1 << 8 : 0);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, textureId);
-  
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexPositionOffset);
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexUvOffset);
-  
-  glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (void*)0);
-  
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
-  
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  // Drawn with the other buttons once the frame is complete
+  Quad::Queue(programId, Atlas::GetTextureId(), instance);
 
   return AppStatus::Success;
 }
@@ -1,17 +1,19 @@
 #version 330 core
 
 in vec2 uv;
+in vec2 imageUv;
+
+flat in vec2 mouse;
+flat in uint activeSide;
+flat in uint isTwoSided;
 
 out vec3 color;
 
 uniform sampler2D image;
-uniform vec2      mouse;
-uniform uint      activeSide;
-uniform uint      isTwoSided;
 
 bool onHover   = mouse.x != -1.0;
 bool onTopLeft = uv.x + uv.y < 1.0;
-vec3 tColor    = texture(image, uv).xyz;
+vec3 tColor    = texture(image, imageUv).xyz;
 
 void main()
 {
@@ -13,6 +13,8 @@
 #include "media.h"
 #include "idrawable.h"
 #include "palette.h"
+#include "quad.h"
+#include "atlas.h"
 
 class Palette;
 struct ButtonDrawable;
@@ -21,7 +23,6 @@ class Button : std::enable_shared_from_this<Button>
 {
 public:
   Button();
-  ~Button();
 
   AppStatus Start
     ( std::string which
@@ -50,20 +51,9 @@ private:
 
   glm::vec2 size;
   glm::vec3 position;
-  glm::mat4 model;
 
-  GLuint programId;
-  GLuint vertexBufferId;
-  GLuint indexBufferId;
-  GLuint textureId;
-  
-  GLint mvpUniformId;
-  GLint mouseUniformId;
-  GLint activeSideUniformId;
-  GLint isTwoSidedUniformId;
-
-  std::vector<GLfloat> vertices;
-  std::vector<GLuint>  indices;
+  GLuint    programId;
+  glm::vec4 iconRect;
 
   std::shared_ptr<ButtonDrawable> drawable;
 };
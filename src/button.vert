@@ -1,15 +1,31 @@
 #version 330 core
 
-layout(location = 0) in vec3 positionModel;
-layout(location = 1) in vec2 inUv;
+layout(location = 0) in vec3  positionModel;
+layout(location = 1) in vec2  inUv;
+layout(location = 2) in vec4  rect;
+layout(location = 3) in vec4  uvRect;
+layout(location = 4) in vec2  inMouse;
+layout(location = 5) in float depth;
+layout(location = 6) in uint  flags;
 
 out vec2 uv;
+out vec2 imageUv;
 
-uniform mat4 mvp;
+flat out vec2 mouse;
+flat out uint activeSide;
+flat out uint isTwoSided;
+
+uniform mat4 viewProjection;
 
 void main()
 {
-    gl_Position = mvp * vec4(positionModel, 1);
+    gl_Position = viewProjection * vec4(rect.xy + positionModel.xy * rect.zw, depth, 1);
+
+    // Buttons have their uv origin in the top left corner
+    uv      = vec2(inUv.x, 1.0 - inUv.y);
+    imageUv = uvRect.xy + uv * uvRect.zw;
 
-    uv = inUv;
+    mouse      = inMouse;
+    activeSide = flags & 0xFFu;
+    isTwoSided = flags >> 8u;
 }
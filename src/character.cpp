@@ -1,12 +1,17 @@
 #include "character.h"
 
-const glm::vec2 frustumSize = App::GetFrustumSize();
-const GLfloat   aspect      = App::GetAspect();
-const glm::vec2 textureSize = glm::vec2(256, 128);
+const glm::vec2 frustumSize  = App::GetFrustumSize();
+const GLfloat   aspect       = App::GetAspect();
+const size_t    textureTiles = 512;
 
 const glm::vec2 Character::size    = glm::vec2(frustumSize.x * 2, frustumSize.x);
 const GLfloat   Character::maxZoom = 24.0f;
 
+const glm::mat4 surface = glm::scale
+  ( glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f))
+  , glm::vec3(Character::GetSize(), 1.0f)
+  );
+
 GLfloat Character::zoom;
 GLfloat Character::nametableZoom;
 
@@ -15,94 +20,121 @@ glm::vec3 Character::nametablePosition;
 glm::mat4 Character::model;
 
 GLuint Character::programId;
-GLuint Character::vertexBufferId;
-GLuint Character::indexBufferId;
-GLuint Character::paletteTextureId;
+GLuint Character::previewProgramId;
 GLuint Character::characterTextureId;
+GLuint Character::previewTextureId;
 
 GLint Character::mvpUniformId;
-GLint Character::mouseUniformId;
-GLint Character::samplesUniformId;
 GLint Character::activeSampleUniformId;
-GLint Character::activeColorUniformId;
-GLint Character::toolUniformId;
-GLint Character::plotStartUniformId;
-GLint Character::plottingUniformId;
-GLint Character::paletteTextureUniformId;
 GLint Character::characterTextureUniformId;
 
-std::vector<GLfloat>     Character::vertices;
-std::vector<GLuint>      Character::indices;
+GLint Character::previewMvpUniformId;
+GLint Character::previewAreaUniformId;
+GLint Character::previewActiveSampleUniformId;
+GLint Character::previewActiveEntryUniformId;
+GLint Character::previewPlottingUniformId;
+GLint Character::previewMousePixelUniformId;
+GLint Character::previewMaskOriginUniformId;
+GLint Character::previewMaskSizeUniformId;
+GLint Character::previewCharacterTextureUniformId;
+GLint Character::previewMaskTextureUniformId;
+GLint Character::previewSelectionOriginUniformId;
+GLint Character::previewSelectionSizeUniformId;
+GLint Character::previewSelectionOffsetUniformId;
+GLint Character::previewSelectionMovingUniformId;
+
 std::vector<std::string> Character::filenames;
-std::vector<GLubyte>     Character::character;
-std::vector<GLubyte>     Character::pixels;
+std::vector<std::string> Character::previewFilenames;
+std::vector<bool>        Character::staleTiles(textureTiles, true);
 
-std::shared_ptr<CharacterDrawable> Character::drawable;
+BankStore Character::store;
+size_t    Character::bank = 0;
 
-AppStatus Character::Start(GLuint textureId)
-{
-  vertices =
-    { -size.x / 2, size.y / 2, -1.0f
-    , 0.0f, 1.0f
-    , size.x / 2, size.y / 2, -1.0f
-    , 1.0, 1.0f
-    , size.x / 2, -size.y / 2, -1.0f
-    , 1.0f, 0.0f
-    , -size.x / 2, -size.y / 2, -1.0f
-    , 0.0f, 0.0f
-    };
+FillBounds Character::fillBounds  = FillBounds::FillCanvas;
+glm::ivec2 Character::strokePixel = glm::ivec2(-1);
 
-  indices = { 0, 1, 2, 2, 3, 0 };
+glm::ivec2  Character::selectionOrigin = glm::ivec2(0);
+glm::ivec2  Character::selectionSize   = glm::ivec2(0);
+bool        Character::tileAligned     = false;
+PlanarImage Character::clipboard;
 
-  filenames = { "character.vert", "character.frag" };
-    
-  for(int y = 0; y < textureSize.y; y++)
-  {
-    for(int x = 0; x < textureSize.x; x++)
-    {
-      character.push_back(0);
-      pixels.push_back(0);
-    }
-  }
+RasterMask Character::previewMask;
+Tool       Character::previewTool = Tool::Pixel;
+glm::ivec2 Character::previewStart = glm::ivec2(-1);
+glm::ivec2 Character::previewEnd   = glm::ivec2(-1);
+
+std::shared_ptr<CharacterDrawable> Character::drawable;
 
-  CharacterToTexture();
+AppStatus Character::Start()
+{
+  filenames        = { "character.vert", "character.frag" };
+  previewFilenames = { "preview.vert", "preview.frag" };
+    
+  store.Reset(nullptr, 0, visibleBanks);
   
   glGenTextures(1, &characterTextureId);
   glActiveTexture(GL_TEXTURE1);
   glBindTexture(GL_TEXTURE_2D, characterTextureId);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, textureSize.x, textureSize.y, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+
+  // One row per visible tile holding its planar bytes, decoded by the shader.
+  // Storage is allocated once, edits only replace the tiles they touch
+  Media::AllocateByteTexture(Codec::TILE_BYTES, textureTiles);
+
+  InvalidateTexture();
 
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-  glGenBuffers(1, &vertexBufferId);
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-  
-  glGenBuffers(1, &indexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
     
   const auto programResult = Media::LoadShaderProgram(filenames);
   if(programResult.first != AppStatus::Success) return programResult.first;
     
   programId = programResult.second;
 
-  paletteTextureId = textureId;
+  Samples::BindUniformBlock(programId);
   
   mvpUniformId              = glGetUniformLocation(programId, "mvp");
-  samplesUniformId          = glGetUniformLocation(programId, "samples");
   activeSampleUniformId     = glGetUniformLocation(programId, "activeSample");
-  activeColorUniformId      = glGetUniformLocation(programId, "activeColor");
-  toolUniformId             = glGetUniformLocation(programId, "tool");
-  plotStartUniformId        = glGetUniformLocation(programId, "plotStart");
-  plottingUniformId         = glGetUniformLocation(programId, "plotting");
-  mouseUniformId            = glGetUniformLocation(programId, "mouse");
-  paletteTextureUniformId   = glGetUniformLocation(programId, "paletteTexture");
   characterTextureUniformId = glGetUniformLocation(programId, "characterTexture");
 
+  const auto previewResult = Media::LoadShaderProgram(previewFilenames);
+  if(previewResult.first != AppStatus::Success) return previewResult.first;
+
+  previewProgramId = previewResult.second;
+
+  Samples::BindUniformBlock(previewProgramId);
+
+  previewMvpUniformId              = glGetUniformLocation(previewProgramId, "mvp");
+  previewAreaUniformId             = glGetUniformLocation(previewProgramId, "area");
+  previewActiveSampleUniformId     = glGetUniformLocation(previewProgramId, "activeSample");
+  previewActiveEntryUniformId      = glGetUniformLocation(previewProgramId, "activeEntry");
+  previewPlottingUniformId         = glGetUniformLocation(previewProgramId, "plotting");
+  previewMousePixelUniformId       = glGetUniformLocation(previewProgramId, "mousePixel");
+  previewMaskOriginUniformId       = glGetUniformLocation(previewProgramId, "maskOrigin");
+  previewMaskSizeUniformId         = glGetUniformLocation(previewProgramId, "maskSize");
+  previewCharacterTextureUniformId = glGetUniformLocation(previewProgramId, "characterTexture");
+  previewMaskTextureUniformId      = glGetUniformLocation(previewProgramId, "maskTexture");
+  previewSelectionOriginUniformId  = glGetUniformLocation(previewProgramId, "selectionOrigin");
+  previewSelectionSizeUniformId    = glGetUniformLocation(previewProgramId, "selectionSize");
+  previewSelectionOffsetUniformId  = glGetUniformLocation(previewProgramId, "selectionOffset");
+  previewSelectionMovingUniformId  = glGetUniformLocation(previewProgramId, "selectionMoving");
+
+  // Covered pixels of the shape being plotted, replaced whenever the plot changes
+  glGenTextures(1, &previewTextureId);
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, previewTextureId);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  previewMask = Raster::Plot(Tool::Pixel, glm::ivec2(0), glm::ivec2(0));
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, 1, 1, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, previewMask.cells.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
   zoom          = 1.0f;
   nametableZoom = 0.5f;
 
@@ -123,12 +155,9 @@ AppStatus Character::Start(GLuint textureId)
 
 AppStatus Character::Stop()
 {
-  GLuint textureIds[] = { characterTextureId };
-  GLuint bufferIds[]  = { vertexBufferId, indexBufferId };
+  GLuint textureIds[] = { characterTextureId, previewTextureId };
   
-  glDeleteTextures(1, textureIds);
-  glDeleteBuffers(2, bufferIds);
-  glDeleteProgram(programId);
+  glDeleteTextures(2, textureIds);
 
   return AppStatus::Success;
 }
@@ -144,7 +173,7 @@ AppStatus Character::Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse)
       , position
       );
       
-    mvp = projection * view * model;
+    mvp = projection * view * model * surface;
   }
   else
   {
@@ -155,63 +184,167 @@ AppStatus Character::Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse)
         , nametablePosition
       );
     
-    mvp = projection * view * model;
+    mvp = projection * view * model * surface;
   }
     
-  const auto samples      = Samples::GetSamples();    
   const auto activeSample = Samples::GetActiveSample();
-  const auto activeColor  = Samples::GetActiveColor();
     
-  auto plotStart = App::ScreenToSurface
+  const auto plotStart = App::ScreenToSurface
     ( App::GetPlotStart()
     , glm::vec2(position.x, position.y) * zoom
     , size
     , zoom
     );
-
-  plotStart.y = 1.0f - plotStart.y;
-
-  mouse.y = 1.0f - mouse.y;
     
+  BindTexture();
+
   glUseProgram(programId);
 
   glUniformMatrix4fv(mvpUniformId, 1, GL_FALSE, &mvp[0][0]);
-  glUniform2fv(mouseUniformId, 1, &mouse[0]);
-  glUniform1uiv(samplesUniformId, samples->size(), samples->data());
   glUniform1ui(activeSampleUniformId, activeSample);
-  glUniform1ui(activeColorUniformId, activeColor);
-  glUniform1ui(toolUniformId, App::GetTool());
-  glUniform2fv(plotStartUniformId, 1, &plotStart[0]);
-  glUniform1ui(plottingUniformId, App::GetPlotting());
-  glUniform1i(paletteTextureUniformId, 0);
   glUniform1i(characterTextureUniformId, 1);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, paletteTextureId);
-  
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, characterTextureId);
+  Quad::Draw();
 
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexPositionOffset);
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexUvOffset);
-  
-  glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (void*)0);
-  
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
-  
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  DrawPreview(mvp, mouse, plotStart);
 
   return AppStatus::Success;
 }
 
+void Character::DrawPreview(glm::mat4 mvp, glm::vec2 mouse, glm::vec2 plotStart)
+{
+  const auto tool    = App::GetTool();
+  const auto hovered = mouse.x >= 0.0f;
+  const auto started = App::GetPlotting() && hovered && plotStart.x != -1;
+
+  // Far off the canvas so that no pixel matches the cursor
+  const auto mousePixel = hovered ? SurfaceToPixel(mouse) : glm::ivec2(-1024);
+  const auto startPixel = started ? SurfaceToPixel(plotStart) : mousePixel;
+
+  // A drag that starts inside the selection moves it, anywhere else it plots
+  const auto moving   = started && tool == Tool::Select && InSelection(startPixel);
+  const auto plotting = started && !moving && tool != Tool::Pixel && tool != Tool::Fill;
+  const auto offset   = moving ? DragOffset(startPixel, mousePixel) : glm::ivec2(0);
+
+  std::vector<glm::vec4> areas;
+
+  if(hovered)
+  {
+    // The cross hair row and column
+    areas.push_back(PixelsToUv(glm::ivec2(0, mousePixel.y), glm::ivec2(rowWords * 64, 1)));
+    areas.push_back(PixelsToUv(glm::ivec2(mousePixel.x, 0), glm::ivec2(1, BankStore::BANK_WIDTH)));
+  }
+
+  if(plotting)
+  {
+    if(tool == Tool::Select)
+    {
+      // Shown as a frame, the selection itself only changes on release
+      const auto rect   = SelectionRect(startPixel, mousePixel);
+      const auto origin = glm::ivec2(rect.x, rect.y);
+
+      UpdatePreviewMask(Tool::RectangleFrame, origin, origin + glm::ivec2(rect.z, rect.w) - 1);
+    }
+    else
+    {
+      UpdatePreviewMask(tool, startPixel, mousePixel);
+    }
+
+    areas.push_back(PixelsToUv(previewMask.origin, previewMask.size));
+  }
+
+  if(selectionSize.x > 0)
+  {
+    // The outline sits just outside the selection, wherever it is dragged to
+    areas.push_back(PixelsToUv(selectionOrigin + offset - 1, selectionSize + 2));
+
+    if(moving) areas.push_back(PixelsToUv(selectionOrigin, selectionSize));
+  }
+
+  glUseProgram(previewProgramId);
+
+  glUniformMatrix4fv(previewMvpUniformId, 1, GL_FALSE, &mvp[0][0]);
+  glUniform1ui(previewActiveSampleUniformId, Samples::GetActiveSample());
+  glUniform1ui(previewActiveEntryUniformId, Samples::GetActiveEntry());
+  glUniform1i(previewPlottingUniformId, plotting);
+  glUniform2i(previewMousePixelUniformId, mousePixel.x, mousePixel.y);
+  glUniform2i(previewMaskOriginUniformId, previewMask.origin.x, previewMask.origin.y);
+  glUniform2i(previewMaskSizeUniformId, previewMask.size.x, previewMask.size.y);
+  glUniform2i(previewSelectionOriginUniformId, selectionOrigin.x, selectionOrigin.y);
+  glUniform2i(previewSelectionSizeUniformId, selectionSize.x, selectionSize.y);
+  glUniform2i(previewSelectionOffsetUniformId, offset.x, offset.y);
+  glUniform1i(previewSelectionMovingUniformId, moving);
+  glUniform1i(previewCharacterTextureUniformId, 1);
+  glUniform1i(previewMaskTextureUniformId, 2);
+
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, previewTextureId);
+
+  // Drawn at the canvas depth over what the canvas just drew
+  glDepthFunc(GL_LEQUAL);
+  glDepthMask(GL_FALSE);
+
+  for(const auto& x : areas)
+  {
+    if(x.z <= 0.0f || x.w <= 0.0f) continue;
+
+    glUniform4fv(previewAreaUniformId, 1, &x[0]);
+
+    Quad::Draw();
+  }
+
+  glDepthMask(GL_TRUE);
+  glDepthFunc(GL_LESS);
+}
+
+glm::vec4 Character::PixelsToUv(glm::ivec2 origin, glm::ivec2 size)
+{
+  const auto pixels = glm::ivec2(rowWords * 64, BankStore::BANK_WIDTH);
+
+  // Kept on the canvas, the overlay must not draw past its edges
+  const auto first = glm::max(origin, glm::ivec2(0));
+  const auto last  = glm::min(origin + size, pixels);
+  const auto area  = glm::vec2(glm::max(last - first, glm::ivec2(0)));
+
+  // Uv grows upwards while pixels count from the top
+  return glm::vec4
+    ( first.x / (float)pixels.x
+    , (pixels.y - last.y) / (float)pixels.y
+    , area.x / pixels.x
+    , area.y / pixels.y
+    );
+}
+
+void Character::UpdatePreviewMask(Tool tool, glm::ivec2 start, glm::ivec2 end)
+{
+  // Rasterized again only when the plot changes, not on every frame
+  if(tool == previewTool && start == previewStart && end == previewEnd) return;
+
+  previewTool  = tool;
+  previewStart = start;
+  previewEnd   = end;
+  previewMask  = Raster::Plot(tool, start, end);
+
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, previewTextureId);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  glTexImage2D
+    ( GL_TEXTURE_2D
+    , 0
+    , GL_R8UI
+    , previewMask.size.x
+    , previewMask.size.y
+    , 0
+    , GL_RED_INTEGER
+    , GL_UNSIGNED_BYTE
+    , previewMask.cells.data()
+    );
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
 bool Character::Click(glm::vec2 mouse)
 {
   const auto mode = App::GetMode();
@@ -219,46 +352,602 @@ bool Character::Click(glm::vec2 mouse)
     
   if(mode == AppMode::CharacterMode)
   {
-    if(tool == Tool::Pixel)
+    // The pencil paints from the cursor samples in Stroke
+    if(tool == Tool::Fill)
     {
-      // TODO: Try to simplify this
-      const float mouseX = (mouse.x > 0.5f ? mouse.x - 0.5f : mouse.x) * 2;
+      return Fill(SurfaceToPixel(mouse));
+    }
+  }
+  else if(mode == AppMode::NametableMode)
+  {
+      
+  }
+        
+  return false;
+}
 
-      const uint bankOffset = mouse.x > 0.5f ? pow(128, 2) : 0;
+bool Character::Release(glm::vec2 mouse)
+{
+  const auto tool = App::GetTool();
 
-      const uint cIndex = bankOffset + floor(mouse.y * 128) * 128 + floor(mouseX * 128);
+  if(App::GetMode() != AppMode::CharacterMode || tool == Tool::Pixel || tool == Tool::Fill) return false;
 
-      const uint pIndex = floor(mouse.y * textureSize.y) * textureSize.x + floor(mouse.x * textureSize.x);
+  // Shapes are only written once the plot is released over the canvas
+  const auto start = App::ScreenToSurface
+    ( App::GetPlotStart()
+    , glm::vec2(position.x, position.y) * zoom
+    , size
+    , zoom
+    );
 
-      const uint activeColor = Samples::GetActiveColor();
+  if(start.x == -1) return false;
 
-      const uint color = activeColor == 12 || activeColor == 24 ? 0 : activeColor % 3 + 1; // TODO: Requires review
-  
-      character[cIndex] = color;
-      pixels[pIndex]    = GLubyte(255 / 3 * color);
-  
-      glActiveTexture(GL_TEXTURE1);
-      glBindTexture(GL_TEXTURE_2D, characterTextureId);
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, textureSize.x, textureSize.y, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+  if(tool == Tool::Select)
+  {
+    const auto from = SurfaceToPixel(start);
+    const auto to   = SurfaceToPixel(mouse);
+
+    if(!InSelection(from))
+    {
+      // A click without a drag lets go of the selection
+      if(from == to) selectionSize = glm::ivec2(0);
+      else           Select(from, to);
+
+      return false;
+    }
+
+    const auto moved = MoveSelection(DragOffset(from, to));
+
+    History::End();
 
-      return true;
+    return moved;
+  }
+
+  const auto result = Commit(Raster::Plot(tool, SurfaceToPixel(start), SurfaceToPixel(mouse)));
+
+  History::End();
+
+  return result;
+}
+
+bool Character::Stroke(View<const CursorSample> samples)
+{
+  std::vector<std::pair<glm::ivec2, glm::ivec2>> segments;
+
+  for(const auto& x : samples)
+  {
+    const auto surface = App::ScreenToSurface
+      ( x.mouse
+      , glm::vec2(position.x, position.y) * zoom
+      , size
+      , zoom
+      );
+
+    // Leaving the canvas breaks the stroke, it picks up again where the cursor returns
+    if(surface.x == -1)
+    {
+      strokePixel = glm::ivec2(-1);
+      continue;
     }
-    else if(tool == Tool::RectangleFrame)
+
+    const auto pixel = SurfaceToPixel(surface);
+
+    segments.push_back({ strokePixel.x == -1 ? pixel : strokePixel, pixel });
+
+    strokePixel = pixel;
+  }
+
+  if(segments.empty()) return false;
+
+  auto first = segments[0].first;
+  auto last  = segments[0].first;
+
+  for(const auto& x : segments)
+  {
+    first = glm::min(first, glm::min(x.first, x.second));
+    last  = glm::max(last, glm::max(x.first, x.second));
+  }
+
+  // All segments of the frame go into one mask, so the tiles are written
+  // and journaled once and uploaded together when the frame is drawn
+  RasterMask stroke;
+
+  stroke.origin = first;
+  stroke.size   = last - first + 1;
+
+  stroke.cells.assign(stroke.size.x * stroke.size.y, 0);
+
+  for(const auto& x : segments) Raster::Merge(&stroke, Raster::Plot(Tool::Line, x.first, x.second));
+
+  return Commit(stroke);
+}
+
+void Character::EndStroke()
+{
+  strokePixel = glm::ivec2(-1);
+
+  // The whole stroke is undone at once
+  History::End();
+}
+
+void Character::RestoreTile(size_t tile, const GLubyte* planar)
+{
+  GLubyte current[Codec::TILE_BYTES];
+
+  store.GetTile(tile, current);
+  store.SetTile(tile, planar);
+
+  Journal::Append(tile, current, planar);
+
+  if(tile >= bank * BankStore::BANK_TILES && tile < (bank + visibleBanks) * BankStore::BANK_TILES)
+  {
+    InvalidateTile(tile - bank * BankStore::BANK_TILES);
+  }
+}
+
+bool Character::Commit(const RasterMask& mask)
+{
+  const auto color = Samples::GetActiveEntry();
+
+  std::map<size_t, std::array<GLubyte, Codec::TILE_BYTES>> before;
+
+  // Tiles are read once before the first of their pixels changes
+  for(int y = 0; y < mask.size.y; y++)
+  {
+    for(int x = 0; x < mask.size.x; x++)
     {
-        
+      if(!mask.Get(x, y)) continue;
+
+      const auto visible = VisibleTile(mask.origin + glm::ivec2(x, y));
+      if(visible == textureTiles || before.count(visible)) continue;
+
+      store.GetTile(bank * BankStore::BANK_TILES + visible, before[visible].data());
     }
   }
-  else if(mode == AppMode::NametableMode)
+
+  if(before.empty()) return false;
+
+  for(int y = 0; y < mask.size.y; y++)
   {
-      
+    for(int x = 0; x < mask.size.x; x++)
+    {
+      if(!mask.Get(x, y)) continue;
+
+      const auto pixel   = mask.origin + glm::ivec2(x, y);
+      const auto visible = VisibleTile(pixel);
+      if(visible == textureTiles) continue;
+
+      store.SetPixel(bank * BankStore::BANK_TILES + visible, pixel.x % 8, pixel.y % 8, color);
+    }
   }
-        
-  return false;
+
+  // The touched tiles are journaled and go up in as few uploads as possible
+  for(const auto& x : before)
+  {
+    const auto tile = bank * BankStore::BANK_TILES + x.first;
+
+    GLubyte after[Codec::TILE_BYTES];
+
+    store.GetTile(tile, after);
+
+    Journal::Append(tile, x.second.data(), after);
+    History::Record(tile, x.second.data(), after);
+
+    InvalidateTile(x.first);
+  }
+
+  return true;
 }
 
-bool Character::Release(glm::vec2 mouse)
+bool Character::Fill(glm::ivec2 pixel)
 {
-  return false;
+  if(VisibleTile(pixel) == textureTiles) return false;
+
+  const size_t sides = std::min(visibleBanks, store.GetBankCount() - bank);
+
+  glm::ivec2 first;
+  glm::ivec2 extent;
+
+  switch(fillBounds)
+  {
+  case FillBounds::FillBank:
+    first  = glm::ivec2(pixel.x / BankStore::BANK_WIDTH * BankStore::BANK_WIDTH, 0);
+    extent = glm::ivec2(BankStore::BANK_WIDTH);
+    break;
+
+  case FillBounds::FillTile:
+    first  = pixel / 8 * 8;
+    extent = glm::ivec2(8);
+    break;
+
+  default:
+    first  = glm::ivec2(0);
+    extent = glm::ivec2(BankStore::BANK_WIDTH * sides, BankStore::BANK_WIDTH);
+  }
+
+  const auto colors = ReadPixels(first, extent);
+  const auto target = colors[(pixel.y - first.y) * extent.x + pixel.x - first.x];
+
+  // Filling with the color already there changes nothing, which also makes
+  // holding the button down over the same area cheap
+  if(target == Samples::GetActiveEntry()) return false;
+
+  const auto result = Commit(Raster::Fill(colors, first, extent, pixel));
+
+  History::End();
+
+  return result;
+}
+
+std::vector<GLubyte> Character::ReadPixels(glm::ivec2 first, glm::ivec2 size)
+{
+  std::vector<GLubyte> colors(size.x * size.y, 0);
+
+  // Regions are whole tiles, the tiles of a row within one bank are decoded in one go
+  const int columns = size.x / 8;
+
+  for(int y = 0; y < size.y / 8; y++)
+  {
+    const auto row = first.y / 8 + y;
+
+    for(int x = 0; x < columns;)
+    {
+      const int  column = first.x / 8 + x;
+      const auto count  = std::min(columns - x, 16 - column % 16);
+      const auto data   = store.GetBank(bank + column / 16);
+
+      if(data != nullptr)
+      {
+        Codec::DecodeTiles
+          ( data + (row * 16 + column % 16) * Codec::TILE_BYTES
+          , count
+          , &colors[y * 8 * size.x + x * 8]
+          , columns
+          );
+      }
+
+      x += count;
+    }
+  }
+
+  return colors;
+}
+
+bool Character::Copy()
+{
+  if(selectionSize.x <= 0) return false;
+
+  clipboard = ReadImage(selectionOrigin, selectionSize);
+
+  return true;
+}
+
+bool Character::Cut()
+{
+  if(!Copy()) return false;
+
+  return DeleteSelection();
+}
+
+bool Character::Paste()
+{
+  if(clipboard.Empty()) return false;
+
+  // Over the selection when there is one, the top left corner otherwise
+  const auto origin = selectionSize.x > 0 ? selectionOrigin : glm::ivec2(0);
+  const auto result = PlaceImage(clipboard, origin);
+
+  History::End();
+
+  Select(origin, origin + clipboard.size - 1);
+
+  return result;
+}
+
+bool Character::DeleteSelection()
+{
+  if(selectionSize.x <= 0) return false;
+
+  const auto result = ClearRect(selectionOrigin, selectionSize);
+
+  History::End();
+
+  return result;
+}
+
+bool Character::TransformTiles(TileTransform transform)
+{
+  return EditTiles([&](GLubyte* planar, size_t count) -> void { Transform::Apply(transform, planar, count); });
+}
+
+bool Character::RemapTiles(const std::array<GLubyte, 4>& entries)
+{
+  return EditTiles([&](GLubyte* planar, size_t count) -> void { Transform::Remap(entries, planar, count); });
+}
+
+bool Character::EditTiles(const std::function<void(GLubyte* planar, size_t count)>& edit)
+{
+  const size_t sides = std::min(visibleBanks, store.GetBankCount() - bank);
+
+  std::vector<size_t> visible;
+
+  // The tiles under the selection, every visible tile without one
+  if(selectionSize.x > 0)
+  {
+    const auto first = selectionOrigin / 8;
+    const auto last  = (selectionOrigin + selectionSize - 1) / 8;
+
+    for(int y = first.y; y <= last.y; y++)
+    {
+      for(int x = first.x; x <= last.x; x++)
+      {
+        const auto tile = VisibleTile(glm::ivec2(x, y) * 8);
+        if(tile != textureTiles) visible.push_back(tile);
+      }
+    }
+  }
+  else
+  {
+    for(size_t tile = 0; tile < sides * BankStore::BANK_TILES; tile++) visible.push_back(tile);
+  }
+
+  if(visible.empty()) return false;
+
+  std::vector<GLubyte> before(visible.size() * Codec::TILE_BYTES);
+
+  for(size_t i = 0; i < visible.size(); i++)
+  {
+    store.GetTile(bank * BankStore::BANK_TILES + visible[i], &before[i * Codec::TILE_BYTES]);
+  }
+
+  // All the tiles go through in one batch
+  auto after = before;
+
+  edit(after.data(), visible.size());
+
+  auto changed = false;
+
+  for(size_t i = 0; i < visible.size(); i++)
+  {
+    const auto tile = bank * BankStore::BANK_TILES + visible[i];
+    const auto from = &before[i * Codec::TILE_BYTES];
+    const auto to   = &after[i * Codec::TILE_BYTES];
+
+    if(std::equal(from, from + Codec::TILE_BYTES, to)) continue;
+
+    store.SetTile(tile, to);
+
+    Journal::Append(tile, from, to);
+    History::Record(tile, from, to);
+
+    InvalidateTile(visible[i]);
+
+    changed = true;
+  }
+
+  History::End();
+
+  return changed;
+}
+
+bool Character::GetTileAligned()
+{
+  return tileAligned;
+}
+
+void Character::SetTileAligned(bool aligned)
+{
+  tileAligned = aligned;
+}
+
+void Character::Select(glm::ivec2 first, glm::ivec2 last)
+{
+  const auto rect = SelectionRect(first, last);
+
+  selectionOrigin = glm::ivec2(rect.x, rect.y);
+  selectionSize   = glm::ivec2(rect.z, rect.w);
+}
+
+glm::ivec4 Character::SelectionRect(glm::ivec2 first, glm::ivec2 last)
+{
+  const auto pixels = glm::ivec2(rowWords * 64, BankStore::BANK_WIDTH);
+
+  auto a = glm::min(first, last);
+  auto b = glm::max(first, last);
+
+  // Tile aligned selections grow outwards to whole tiles
+  if(tileAligned)
+  {
+    a = a / 8 * 8;
+    b = b / 8 * 8 + 7;
+  }
+
+  a = glm::clamp(a, glm::ivec2(0), pixels - 1);
+  b = glm::clamp(b, glm::ivec2(0), pixels - 1);
+
+  return glm::ivec4(a, b - a + 1);
+}
+
+bool Character::InSelection(glm::ivec2 pixel)
+{
+  return selectionSize.x > 0
+      && pixel.x >= selectionOrigin.x && pixel.x < selectionOrigin.x + selectionSize.x
+      && pixel.y >= selectionOrigin.y && pixel.y < selectionOrigin.y + selectionSize.y;
+}
+
+glm::ivec2 Character::DragOffset(glm::ivec2 from, glm::ivec2 to)
+{
+  const auto offset = to - from;
+
+  return tileAligned ? offset / 8 * 8 : offset;
+}
+
+bool Character::MoveSelection(glm::ivec2 offset)
+{
+  if(selectionSize.x <= 0 || (offset.x == 0 && offset.y == 0)) return false;
+
+  // Lifted out, the hole is left with the background and the pixels are put down at the offset
+  const auto image   = ReadImage(selectionOrigin, selectionSize);
+  const auto cleared = ClearRect(selectionOrigin, selectionSize);
+  const auto placed  = PlaceImage(image, selectionOrigin + offset);
+
+  const auto destination = selectionOrigin + offset;
+
+  Select(destination, destination + selectionSize - 1);
+
+  return cleared || placed;
+}
+
+PlanarImage Character::ReadImage(glm::ivec2 origin, glm::ivec2 size)
+{
+  PlanarImage image;
+
+  image.Reset(size);
+
+  const GLubyte* banks[visibleBanks];
+
+  for(size_t side = 0; side < visibleBanks; side++) banks[side] = store.GetBank(bank + side);
+
+  uint64_t low[rowWords + 1]  = {};
+  uint64_t high[rowWords + 1] = {};
+
+  for(int y = 0; y < size.y; y++)
+  {
+    Blit::PackRow(banks, visibleBanks, origin.y + y, low, high);
+
+    Blit::Extract(low, origin.x, size.x, &image.low[y * image.stride]);
+    Blit::Extract(high, origin.x, size.x, &image.high[y * image.stride]);
+  }
+
+  return image;
+}
+
+bool Character::PlaceImage(const PlanarImage& image, glm::ivec2 origin)
+{
+  const auto pixels = glm::ivec2(rowWords * 64, BankStore::BANK_WIDTH);
+
+  // Pixels that land off the canvas are dropped
+  const auto first = glm::max(origin, glm::ivec2(0));
+  const auto last  = glm::min(origin + image.size, pixels) - 1;
+
+  if(last.x < first.x || last.y < first.y) return false;
+
+  const auto skip  = first.x - origin.x;
+  const auto width = last.x - first.x + 1;
+
+  return EditRows
+    ( first.y
+    , last.y
+    , [&](int y, uint64_t* low, uint64_t* high) -> void
+      {
+        const auto source = (y - origin.y) * image.stride;
+
+        uint64_t run[rowWords + 1];
+
+        Blit::Extract(&image.low[source], skip, width, run);
+        Blit::Insert(low, first.x, width, run);
+
+        Blit::Extract(&image.high[source], skip, width, run);
+        Blit::Insert(high, first.x, width, run);
+      }
+    );
+}
+
+bool Character::ClearRect(glm::ivec2 origin, glm::ivec2 size)
+{
+  return EditRows
+    ( origin.y
+    , origin.y + size.y - 1
+    , [&](int y, uint64_t* low, uint64_t* high) -> void
+      {
+        Blit::Clear(low, origin.x, size.x);
+        Blit::Clear(high, origin.x, size.x);
+      }
+    );
+}
+
+bool Character::EditRows
+  ( int first
+  , int last
+  , const std::function<void(int y, uint64_t* low, uint64_t* high)>& edit
+  )
+{
+  const GLubyte* banks[visibleBanks];
+
+  for(size_t side = 0; side < visibleBanks; side++) banks[side] = store.GetBank(bank + side);
+
+  const size_t columns = std::min(visibleBanks, store.GetBankCount() - bank) * 16;
+
+  std::map<size_t, std::pair<std::array<GLubyte, Codec::TILE_BYTES>, std::array<GLubyte, Codec::TILE_BYTES>>> tiles;
+
+  uint64_t low[rowWords + 1]  = {};
+  uint64_t high[rowWords + 1] = {};
+
+  for(int y = first; y <= last; y++)
+  {
+    Blit::PackRow(banks, visibleBanks, y, low, high);
+
+    edit(y, low, high);
+
+    // Back into the tiles a byte at a time, only where the row changed
+    for(size_t column = 0; column < columns; column++)
+    {
+      const auto side    = column / 16;
+      const auto visible = side * BankStore::BANK_TILES + (y / 8) * 16 + column % 16;
+      const auto data    = banks[side] + (visible % BankStore::BANK_TILES) * Codec::TILE_BYTES;
+      const auto row     = y % 8;
+
+      const auto newLow  = Blit::RowByte(low, column);
+      const auto newHigh = Blit::RowByte(high, column);
+
+      if(newLow == data[row] && newHigh == data[row + 8]) continue;
+
+      auto x = tiles.find(visible);
+
+      if(x == tiles.end())
+      {
+        x = tiles.emplace(visible, std::make_pair(std::array<GLubyte, Codec::TILE_BYTES>(), std::array<GLubyte, Codec::TILE_BYTES>())).first;
+
+        std::copy(data, data + Codec::TILE_BYTES, x->second.first.begin());
+        x->second.second = x->second.first;
+      }
+
+      x->second.second[row]     = newLow;
+      x->second.second[row + 8] = newHigh;
+    }
+  }
+
+  // Written only after all rows are read, the writes may copy the banks
+  for(const auto& x : tiles)
+  {
+    const auto tile = bank * BankStore::BANK_TILES + x.first;
+
+    store.SetTile(tile, x.second.second.data());
+
+    Journal::Append(tile, x.second.first.data(), x.second.second.data());
+    History::Record(tile, x.second.first.data(), x.second.second.data());
+
+    InvalidateTile(x.first);
+  }
+
+  return !tiles.empty();
+}
+
+glm::ivec2 Character::SurfaceToPixel(glm::vec2 surface)
+{
+  const auto pixels = glm::vec2(BankStore::BANK_WIDTH * visibleBanks, BankStore::BANK_WIDTH);
+
+  return glm::clamp(glm::ivec2(glm::floor(surface * pixels)), glm::ivec2(0), glm::ivec2(pixels) - 1);
+}
+
+size_t Character::VisibleTile(glm::ivec2 pixel)
+{
+  const size_t side = pixel.x / BankStore::BANK_WIDTH;
+
+  // Banks past the end of the file have no tiles to draw on
+  if(bank + side >= store.GetBankCount()) return textureTiles;
+
+  return side * BankStore::BANK_TILES + (pixel.y / 8) * 16 + (pixel.x % BankStore::BANK_WIDTH) / 8;
 }
 
 glm::vec2 Character::GetPosition()
@@ -271,27 +960,79 @@ glm::vec2 Character::GetSize()
   return size;
 }
 
-AppStatus Character::SetCharacter(std::vector<GLubyte> newCharacter)
+AppStatus Character::SetCharacter(std::shared_ptr<const GLubyte> planar, size_t tiles)
 {
-  character = newCharacter;
+  // Banks are decoded from the source once they come into view
+  store.Reset(planar, tiles, visibleBanks);
 
-  CharacterToTexture();
+  // Edits of the previous document can't be undone into this one
+  History::Clear();
+  bank = 0;
 
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, characterTextureId);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, textureSize.x, textureSize.y, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+  InvalidateTexture();
   
   return AppStatus::Success;
 }
 
-std::vector<GLubyte> Character::GetCharacter()
+BankSnapshot Character::GetSnapshot()
+{
+  return store.GetSnapshot();
+}
+
+std::vector<std::pair<size_t, size_t>> Character::GetDirtyRuns()
 {
-  return character;
+  return store.GetDirtyRuns();
 }
 
-std::vector<GLubyte> Character::GetPixels()
-{    
-  return pixels;
+void Character::ClearDirty()
+{
+  store.ClearDirty();
+}
+
+void Character::GetTile(size_t tile, GLubyte* planar)
+{
+  store.GetTile(tile, planar);
+}
+
+void Character::SetTile(size_t tile, const GLubyte* planar)
+{
+  store.SetTile(tile, planar);
+}
+
+void Character::MarkDirty(size_t first, size_t count)
+{
+  for(size_t i = first; i < first + count; i++) store.MarkDirty(i);
+}
+
+size_t Character::GetTileCount()
+{
+  return store.GetTileCount();
+}
+
+size_t Character::GetBank()
+{
+  return bank;
+}
+
+size_t Character::GetBankCount()
+{
+  return store.GetBankCount();
+}
+
+void Character::SetBank(size_t newBank)
+{
+  const auto last = store.GetBankCount() - visibleBanks;
+
+  bank = newBank > last ? last : newBank;
+
+  store.Trim(bank, visibleBanks);
+
+  Refresh();
+}
+
+void Character::Refresh()
+{
+  InvalidateTexture();
 }
 
 std::shared_ptr<IDrawable> Character::GetDrawable()
@@ -314,6 +1055,16 @@ float Character::GetZoom()
   return zoom;
 }
 
+FillBounds Character::GetFillBounds()
+{
+  return fillBounds;
+}
+
+void Character::SetFillBounds(FillBounds bounds)
+{
+  fillBounds = bounds;
+}
+
 void Character::SetZoom(GLfloat amount)
 {
   const GLfloat proposedZoom
@@ -324,23 +1075,89 @@ void Character::SetZoom(GLfloat amount)
   zoom = proposedZoom;
 }
 
-void Character::CharacterToTexture()
+void Character::InvalidateTexture()
+{
+  std::fill(staleTiles.begin(), staleTiles.end(), true);
+}
+
+void Character::InvalidateTile(size_t tile)
+{
+  staleTiles[tile] = true;
+}
+
+void Character::BindTexture()
 {
-  pixels = std::vector<GLubyte>(pow(128, 2) * 2);
+  UploadTexture();
 
-  for(uint bank = 0; bank < 2; bank++)
+  // Unit 1 is where every shader that decodes tiles expects them
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, characterTextureId);
+}
+
+bool Character::GetActiveTile(size_t side, GLubyte* tile)
+{
+  if(selectionSize.x <= 0) return false;
+
+  // The tile at the top left of the selection, what the nametable places
+  const auto visible = VisibleTile(selectionOrigin);
+
+  if(visible == textureTiles || visible / BankStore::BANK_TILES != side) return false;
+
+  *tile = visible % BankStore::BANK_TILES;
+
+  return true;
+}
+
+void Character::UploadTexture()
+{
+  if(std::find(staleTiles.begin(), staleTiles.end(), true) == staleTiles.end()) return;
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, characterTextureId);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  // Neighbouring stale tiles of a bank go up together
+  for(size_t side = 0; side < visibleBanks; side++)
   {
-    for(uint y = 0; y < 128; y++)
+    const auto data = store.GetBank(bank + side);
+    if(data == nullptr) continue;
+
+    const auto offset = side * BankStore::BANK_TILES;
+
+    size_t tile = 0;
+
+    while(tile < BankStore::BANK_TILES)
     {
-      for(uint x = 0; x < 128; x++)
+      if(!staleTiles[offset + tile])
       {
-        const auto i = y * textureSize.x + bank * 128 + x;
-        const auto c = 255 / 3 * character[bank * pow(128, 2) + y * 128 + x];
-        
-        pixels[i] = c;
+        tile++;
+        continue;
       }
+
+      const auto first = tile;
+
+      while(tile < BankStore::BANK_TILES && staleTiles[offset + tile])
+      {
+        staleTiles[offset + tile] = false;
+        tile++;
+      }
+
+      glTexSubImage2D
+        ( GL_TEXTURE_2D
+        , 0
+        , 0
+        , offset + first
+        , Codec::TILE_BYTES
+        , tile - first
+        , GL_RED_INTEGER
+        , GL_UNSIGNED_BYTE
+        , data + first * Codec::TILE_BYTES
+        );
     }
   }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
 void Character::Zoom(GLfloat amount)
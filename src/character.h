@@ -7,6 +7,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
 #include <memory>
+#include <map>
+#include <array>
+#include <functional>
 
 #include "app.h"
 #include "appstatus.h"
@@ -15,13 +18,30 @@
 #include "palette.h"
 #include "offset.h"
 #include "idrawable.h"
+#include "quad.h"
+#include "bankstore.h"
+#include "journal.h"
+#include "history.h"
+#include "raster.h"
+#include "cursorsample.h"
+#include "view.h"
+#include "blit.h"
+#include "transform.h"
 
 struct CharacterDrawable;
 
+// How far a fill may spread from the pixel it starts on
+enum FillBounds
+{
+  FillCanvas = 0,
+  FillBank,
+  FillTile
+};
+
 class Character
 {
 public:
-  static AppStatus Start(GLuint textureId);
+  static AppStatus Start();
   static AppStatus Stop();
   static AppStatus Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse);
 
@@ -30,24 +50,90 @@ public:
   static void Move(glm::vec2 displacement);
   static void Zoom(GLfloat amount);
 
-  static GLfloat   GetZoom();
+  static GLfloat    GetZoom();
+  static FillBounds GetFillBounds();
   static glm::vec2 GetPosition();
   static glm::vec2 GetSize();
 
   static std::shared_ptr<IDrawable> GetDrawable();
 
-  static AppStatus SetCharacter(std::vector<GLubyte> character);
+  static AppStatus SetCharacter(std::shared_ptr<const GLubyte> planar, size_t tiles);
 
   static void SetZoom(GLfloat amount);
+  static void SetFillBounds(FillBounds bounds);
+
+  static bool Stroke(View<const CursorSample> samples);
+  static void EndStroke();
+
+  static bool Copy();
+  static bool Cut();
+  static bool Paste();
+  static bool DeleteSelection();
+
+  static bool TransformTiles(TileTransform transform);
+  static bool RemapTiles(const std::array<GLubyte, 4>& entries);
+
+  static void SetTileAligned(bool aligned);
+  static bool GetTileAligned();
+  static void SetBank(size_t bank);
+
+  static void BindTexture();
+
+  // False without a selection or when it is not in the given visible bank
+  static bool GetActiveTile(size_t side, GLubyte* tile);
+
+  static void ClearDirty();
+  static void MarkDirty(size_t first, size_t count);
+  static void GetTile(size_t tile, GLubyte* planar);
+  static void SetTile(size_t tile, const GLubyte* planar);
+  static void RestoreTile(size_t tile, const GLubyte* planar);
+  static void Refresh();
 
-  static std::vector<GLubyte> GetCharacter();
-  static std::vector<GLubyte> GetPixels();
+  static std::vector<std::pair<size_t, size_t>> GetDirtyRuns();
+
+  static BankSnapshot GetSnapshot();
+
+  static size_t GetTileCount();
+  static size_t GetBank();
+  static size_t GetBankCount();
 
 private:
-  static void CharacterToTexture();
+  static void InvalidateTexture();
+  static void InvalidateTile(size_t tile);
+  static void UploadTexture();
+  static void DrawPreview(glm::mat4 mvp, glm::vec2 mouse, glm::vec2 plotStart);
+  static void UpdatePreviewMask(Tool tool, glm::ivec2 start, glm::ivec2 end);
+  static bool Commit(const RasterMask& mask);
+  static bool Fill(glm::ivec2 pixel);
+
+  // Entries of a tile aligned region, row by row
+  static std::vector<GLubyte> ReadPixels(glm::ivec2 first, glm::ivec2 size);
+
+  static PlanarImage ReadImage(glm::ivec2 origin, glm::ivec2 size);
+  static bool        PlaceImage(const PlanarImage& image, glm::ivec2 origin);
+  static bool        ClearRect(glm::ivec2 origin, glm::ivec2 size);
+  static bool        MoveSelection(glm::ivec2 offset);
+  static void        Select(glm::ivec2 first, glm::ivec2 last);
+  static glm::ivec4  SelectionRect(glm::ivec2 first, glm::ivec2 last);
+  static bool        InSelection(glm::ivec2 pixel);
+  static glm::ivec2  DragOffset(glm::ivec2 from, glm::ivec2 to);
+  static glm::vec4   PixelsToUv(glm::ivec2 origin, glm::ivec2 size);
+
+  static bool EditTiles(const std::function<void(GLubyte* planar, size_t count)>& edit);
+
+  static bool EditRows
+    ( int first
+    , int last
+    , const std::function<void(int y, uint64_t* low, uint64_t* high)>& edit
+    );
+
+  static glm::ivec2 SurfaceToPixel(glm::vec2 surface);
+  static size_t     VisibleTile(glm::ivec2 pixel);
   
   static const glm::vec2 size;
   static const GLfloat   maxZoom;
+  static constexpr size_t visibleBanks = 2;
+  static constexpr size_t rowWords     = visibleBanks * BankStore::BANK_WIDTH / 64;
   
   static GLfloat zoom;
   static GLfloat nametableZoom;
@@ -57,27 +143,48 @@ private:
   static glm::mat4 model;
   
   static GLuint programId;
-  static GLuint vertexBufferId;
-  static GLuint indexBufferId;
-  static GLuint paletteTextureId;
+  static GLuint previewProgramId;
   static GLuint characterTextureId;
+  static GLuint previewTextureId;
   
   static GLint mvpUniformId;
-  static GLint mouseUniformId;
-  static GLint samplesUniformId;
   static GLint activeSampleUniformId;
-  static GLint activeColorUniformId;
-  static GLint toolUniformId;
-  static GLint plottingUniformId;
-  static GLint plotStartUniformId;
-  static GLint paletteTextureUniformId;
   static GLint characterTextureUniformId;
+
+  static GLint previewMvpUniformId;
+  static GLint previewAreaUniformId;
+  static GLint previewActiveSampleUniformId;
+  static GLint previewActiveEntryUniformId;
+  static GLint previewPlottingUniformId;
+  static GLint previewMousePixelUniformId;
+  static GLint previewMaskOriginUniformId;
+  static GLint previewMaskSizeUniformId;
+  static GLint previewCharacterTextureUniformId;
+  static GLint previewMaskTextureUniformId;
+  static GLint previewSelectionOriginUniformId;
+  static GLint previewSelectionSizeUniformId;
+  static GLint previewSelectionOffsetUniformId;
+  static GLint previewSelectionMovingUniformId;
     
-  static std::vector<GLfloat>     vertices;
-  static std::vector<GLuint>      indices;
   static std::vector<std::string> filenames;
-  static std::vector<GLubyte>     character;
-  static std::vector<GLubyte>     pixels;
+  static std::vector<std::string> previewFilenames;
+  static std::vector<bool>        staleTiles;
+
+  static FillBounds fillBounds;
+  static glm::ivec2 strokePixel;
+
+  static glm::ivec2  selectionOrigin;
+  static glm::ivec2  selectionSize;
+  static bool        tileAligned;
+  static PlanarImage clipboard;
+
+  static RasterMask previewMask;
+  static Tool       previewTool;
+  static glm::ivec2 previewStart;
+  static glm::ivec2 previewEnd;
+
+  static BankStore store;
+  static size_t    bank;
 
   static std::shared_ptr<CharacterDrawable> drawable;
 };
@@ -101,6 +208,11 @@ struct CharacterDrawable : public IDrawable
     return Character::GetSize();
   }
 
+  GLfloat GetZoom() override
+  {
+    return Character::GetZoom();
+  }
+
   bool Click(glm::vec2 mouse) override
   {
     return Character::Click(mouse);
@@ -0,0 +1,181 @@
+#include "codec.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CODEC_X86
+#endif
+
+// Spreads the 8 bits of a plane row over 8 bytes, leftmost pixel first
+static uint64_t spread[256];
+
+Codec::Decoder Codec::decoder;
+
+static GLubyte* TileOrigin(GLubyte* sheet, size_t tile, size_t tilesPerRow)
+{
+  const auto stride = tilesPerRow * 8;
+
+  return sheet + (tile / tilesPerRow) * stride * 8 + (tile % tilesPerRow) * 8;
+}
+
+static void DecodeTilesScalar(const GLubyte* planar, size_t count, GLubyte* chunky, size_t tilesPerRow)
+{
+  const auto stride = tilesPerRow * 8;
+
+  for(size_t tile = 0; tile < count; tile++, planar += Codec::TILE_BYTES)
+  {
+    auto out = TileOrigin(chunky, tile, tilesPerRow);
+
+    for(size_t y = 0; y < 8; y++, out += stride)
+    {
+      const uint64_t row = spread[planar[y]] | (spread[planar[y + 8]] << 1);
+      memcpy(out, &row, 8);
+    }
+  }
+}
+
+#ifdef CODEC_X86
+
+static void DecodeTilesSSE2(const GLubyte* planar, size_t count, GLubyte* chunky, size_t tilesPerRow)
+{
+  const auto stride = tilesPerRow * 8;
+
+  const __m128i mask = _mm_setr_epi8
+    ( (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01
+    , (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01
+    );
+
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i two = _mm_set1_epi8(2);
+
+  for(size_t tile = 0; tile < count; tile++, planar += Codec::TILE_BYTES)
+  {
+    auto out = TileOrigin(chunky, tile, tilesPerRow);
+
+    // Broadcast every plane byte over the 8 pixels of its row, two rows per register
+    const __m128i lo = _mm_loadl_epi64((const __m128i*)planar);
+    const __m128i hi = _mm_loadl_epi64((const __m128i*)(planar + 8));
+
+    const __m128i lo8 = _mm_unpacklo_epi8(lo, lo);
+    const __m128i hi8 = _mm_unpacklo_epi8(hi, hi);
+
+    const __m128i lo16[] = { _mm_unpacklo_epi16(lo8, lo8), _mm_unpackhi_epi16(lo8, lo8) };
+    const __m128i hi16[] = { _mm_unpacklo_epi16(hi8, hi8), _mm_unpackhi_epi16(hi8, hi8) };
+
+    for(size_t pair = 0; pair < 4; pair++, out += stride * 2)
+    {
+      const __m128i l = pair % 2 == 0
+        ? _mm_unpacklo_epi32(lo16[pair / 2], lo16[pair / 2])
+        : _mm_unpackhi_epi32(lo16[pair / 2], lo16[pair / 2]);
+
+      const __m128i h = pair % 2 == 0
+        ? _mm_unpacklo_epi32(hi16[pair / 2], hi16[pair / 2])
+        : _mm_unpackhi_epi32(hi16[pair / 2], hi16[pair / 2]);
+
+      const __m128i p = _mm_or_si128
+        ( _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(l, mask), mask), one)
+        , _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(h, mask), mask), two)
+        );
+
+      _mm_storel_epi64((__m128i*)out, p);
+      _mm_storel_epi64((__m128i*)(out + stride), _mm_srli_si128(p, 8));
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+static void DecodeTilesAVX2(const GLubyte* planar, size_t count, GLubyte* chunky, size_t tilesPerRow)
+{
+  const auto stride = tilesPerRow * 8;
+
+  const __m256i mask = _mm256_set1_epi64x(0x0102040810204080ll);
+  const __m256i one  = _mm256_set1_epi8(1);
+  const __m256i two  = _mm256_set1_epi8(2);
+
+  // Each lane broadcasts two plane bytes over two rows, four rows per register
+  const __m256i rows[] =
+    { _mm256_setr_epi8
+        ( 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1
+        , 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+        )
+    , _mm256_setr_epi8
+        ( 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5
+        , 6, 6, 6, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7
+        )
+    };
+
+  const __m256i high = _mm256_set1_epi8(8);
+
+  for(size_t tile = 0; tile < count; tile++, planar += Codec::TILE_BYTES)
+  {
+    auto out = TileOrigin(chunky, tile, tilesPerRow);
+
+    const __m256i source = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)planar));
+
+    for(size_t half = 0; half < 2; half++, out += stride * 4)
+    {
+      const __m256i l = _mm256_shuffle_epi8(source, rows[half]);
+      const __m256i h = _mm256_shuffle_epi8(source, _mm256_add_epi8(rows[half], high));
+
+      const __m256i p = _mm256_or_si256
+        ( _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(l, mask), mask), one)
+        , _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(h, mask), mask), two)
+        );
+
+      const __m128i p01 = _mm256_castsi256_si128(p);
+      const __m128i p23 = _mm256_extracti128_si256(p, 1);
+
+      _mm_storel_epi64((__m128i*)out, p01);
+      _mm_storel_epi64((__m128i*)(out + stride), _mm_srli_si128(p01, 8));
+      _mm_storel_epi64((__m128i*)(out + stride * 2), p23);
+      _mm_storel_epi64((__m128i*)(out + stride * 3), _mm_srli_si128(p23, 8));
+    }
+  }
+}
+
+#endif
+
+AppStatus Codec::Start()
+{
+  for(uint32_t b = 0; b < 256; b++)
+  {
+    uint64_t row = 0;
+
+    for(uint32_t x = 0; x < 8; x++)
+    {
+      row |= (uint64_t)((b >> (7 - x)) & 1) << (x * 8);
+    }
+
+    spread[b] = row;
+  }
+
+  decoder = DecodeTilesScalar;
+
+  std::string backend = "scalar";
+
+#ifdef CODEC_X86
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx2"))
+  {
+    decoder = DecodeTilesAVX2;
+    backend = "AVX2";
+  }
+  else if(__builtin_cpu_supports("sse2"))
+  {
+    decoder = DecodeTilesSSE2;
+    backend = "SSE2";
+  }
+#endif
+
+  Debug::Log(LogLevel::Info, "Using " + backend + " tile codec");
+
+  return AppStatus::Success;
+}
+
+void Codec::DecodeTiles(const GLubyte* planar, size_t count, GLubyte* chunky, size_t tilesPerRow)
+{
+  decoder(planar, count, chunky, tilesPerRow);
+}
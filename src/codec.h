@@ -0,0 +1,40 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <GL/glew.h>
+#include <string>
+#include <cstddef>
+
+#include "appstatus.h"
+#include "debug.h"
+
+/*
+  Decodes NES 2bpp tiles from planar form (16 bytes, 8 low plane rows
+  followed by 8 high plane rows) to chunky form (one byte per pixel, 0 - 3),
+  for code that works on the pixels of many tiles at once on the CPU.
+
+  Tiles are laid out in a sheet that is tilesPerRow tiles wide, so a run of
+  tiles can be decoded in one call straight into its final storage.
+*/
+class Codec
+{
+public:
+  static constexpr size_t TILE_BYTES  = 16;
+  static constexpr size_t TILE_PIXELS = 64;
+
+  static AppStatus Start();
+
+  static void DecodeTiles
+    ( const GLubyte* planar
+    , size_t count
+    , GLubyte* chunky
+    , size_t tilesPerRow
+    );
+
+private:
+  typedef void (*Decoder)(const GLubyte*, size_t, GLubyte*, size_t);
+
+  static Decoder decoder;
+};
+
+#endif
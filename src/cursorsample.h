@@ -0,0 +1,14 @@
+#ifndef CURSORSAMPLE_H
+#define CURSORSAMPLE_H
+
+#include <glm/glm.hpp>
+
+// One cursor position as GLFW reported it, in the same space as App's mouse
+struct CursorSample
+{
+  glm::vec2 mouse;
+  double    time;
+  bool      last; // Where the button went up, the end of its stroke
+};
+
+#endif
@@ -61,6 +61,26 @@ void Debug::LogStatus(AppStatus status)
     stream << "Failed to load texture";
     break;
 
+  case AppStatus::FailureRomHeader:
+    stream << "Failed to read ROM header";
+    break;
+
+  case AppStatus::FailureCharacterSave:
+    stream << "Failed to save character";
+    break;
+
+  case AppStatus::FailureCharacterLoad:
+    stream << "Failed to load character";
+    break;
+
+  case AppStatus::FailureFramebuffer:
+    stream << "Failed to create the frame target";
+    break;
+
+  case AppStatus::FailureMapLoad:
+    stream << "Failed to open the map";
+    break;
+
   case AppStatus::Success:
     // stream << ""; // No need to log this
     break;
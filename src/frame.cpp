@@ -0,0 +1,114 @@
+#include "frame.h"
+
+glm::ivec2 Frame::size;
+
+GLuint Frame::framebufferId       = 0;
+GLuint Frame::colorRenderbufferId = 0;
+GLuint Frame::depthRenderbufferId = 0;
+
+AppStatus Frame::Start()
+{
+  int width;
+  int height;
+
+  // The window can have more pixels than screen coordinates
+  glfwGetFramebufferSize(glfwGetCurrentContext(), &width, &height);
+
+  size = glm::ivec2(width, height);
+
+  return CreateTargets();
+}
+
+AppStatus Frame::Stop()
+{
+  DeleteTargets();
+
+  return AppStatus::Success;
+}
+
+AppStatus Frame::Resize(glm::ivec2 newSize)
+{
+  if(newSize.x <= 0 || newSize.y <= 0) return AppStatus::Success;
+
+  DeleteTargets();
+
+  size = newSize;
+
+  return CreateTargets();
+}
+
+void Frame::Begin(glm::ivec4 area)
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+
+  // Everything outside the area keeps what the previous frames drew
+  const bool partial = area.x > 0 || area.y > 0 || area.z < size.x || area.w < size.y;
+
+  if(partial)
+  {
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(area.x, area.y, area.z, area.w);
+  }
+
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void Frame::End()
+{
+  glDisable(GL_SCISSOR_TEST);
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferId);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+  glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+}
+
+glm::ivec2 Frame::GetSize()
+{
+  return size;
+}
+
+AppStatus Frame::CreateTargets()
+{
+  GLuint renderbufferIds[2];
+
+  glGenFramebuffers(1, &framebufferId);
+  glGenRenderbuffers(2, renderbufferIds);
+
+  colorRenderbufferId = renderbufferIds[0];
+  depthRenderbufferId = renderbufferIds[1];
+
+  glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbufferId);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+
+  glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbufferId);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size.x, size.y);
+
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbufferId);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbufferId);
+
+  if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return AppStatus::FailureFramebuffer;
+  }
+
+  glViewport(0, 0, size.x, size.y);
+
+  return AppStatus::Success;
+}
+
+void Frame::DeleteTargets()
+{
+  const GLuint renderbufferIds[] = { colorRenderbufferId, depthRenderbufferId };
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  glDeleteFramebuffers(1, &framebufferId);
+  glDeleteRenderbuffers(2, renderbufferIds);
+}
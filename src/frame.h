@@ -0,0 +1,40 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "appstatus.h"
+
+/*
+  Offscreen target every frame is drawn into.
+
+  The window's back buffer is undefined after a swap, so it cannot keep
+  what was drawn before. This target does, which lets a frame redraw only
+  the damaged area under a scissor and copy the whole image to the window.
+*/
+class Frame
+{
+public:
+  static AppStatus Start();
+  static AppStatus Stop();
+  static AppStatus Resize(glm::ivec2 size);
+
+  static void Begin(glm::ivec4 area);
+  static void End();
+
+  static glm::ivec2 GetSize();
+
+private:
+  static AppStatus CreateTargets();
+  static void      DeleteTargets();
+
+  static glm::ivec2 size;
+
+  static GLuint framebufferId;
+  static GLuint colorRenderbufferId;
+  static GLuint depthRenderbufferId;
+};
+
+#endif
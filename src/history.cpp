@@ -0,0 +1,140 @@
+#include "history.h"
+
+size_t History::capacity = 8 * 1024 * 1024;
+size_t History::usage    = 0;
+
+std::deque<History::Transaction> History::undo;
+std::deque<History::Transaction> History::redo;
+
+History::Transaction                  History::open;
+std::unordered_map<uint32_t, size_t> History::openTiles;
+
+void History::Record(size_t tile, const GLubyte* before, const GLubyte* after)
+{
+  const auto existing = openTiles.find(tile);
+
+  // A tile touched again within the transaction keeps its first before image
+  if(existing != openTiles.end())
+  {
+    memcpy(open[existing->second].after, after, Codec::TILE_BYTES);
+    return;
+  }
+
+  TileDelta delta;
+
+  delta.tile = tile;
+
+  memcpy(delta.before, before, Codec::TILE_BYTES);
+  memcpy(delta.after, after, Codec::TILE_BYTES);
+
+  openTiles[tile] = open.size();
+  open.push_back(delta);
+}
+
+void History::End()
+{
+  // Tiles that ended up as they started are left out
+  open.erase
+    ( std::remove_if
+      ( open.begin()
+      , open.end()
+      , [](const TileDelta& x) -> bool
+        {
+          return memcmp(x.before, x.after, Codec::TILE_BYTES) == 0;
+        }
+      )
+    , open.end()
+    );
+
+  openTiles.clear();
+
+  if(open.empty()) return;
+
+  open.shrink_to_fit();
+
+  // A new edit makes the undone ones unreachable
+  for(const auto& x : redo) usage -= Size(x);
+  redo.clear();
+
+  usage += Size(open);
+  undo.push_back(std::move(open));
+
+  open = Transaction();
+
+  Trim();
+}
+
+bool History::Undo()
+{
+  End();
+
+  if(undo.empty()) return false;
+
+  auto transaction = std::move(undo.back());
+  undo.pop_back();
+
+  for(auto x = transaction.rbegin(); x != transaction.rend(); x++)
+  {
+    Character::RestoreTile(x->tile, x->before);
+  }
+
+  redo.push_back(std::move(transaction));
+
+  return true;
+}
+
+bool History::Redo()
+{
+  End();
+
+  if(redo.empty()) return false;
+
+  auto transaction = std::move(redo.back());
+  redo.pop_back();
+
+  for(const auto& x : transaction) Character::RestoreTile(x.tile, x.after);
+
+  undo.push_back(std::move(transaction));
+
+  return true;
+}
+
+void History::Clear()
+{
+  open.clear();
+  openTiles.clear();
+
+  undo.clear();
+  redo.clear();
+
+  usage = 0;
+}
+
+void History::SetCapacity(size_t bytes)
+{
+  capacity = bytes;
+
+  Trim();
+}
+
+size_t History::GetUsage()
+{
+  return usage;
+}
+
+size_t History::Size(const Transaction& transaction)
+{
+  return sizeof(Transaction) + transaction.capacity() * sizeof(TileDelta);
+}
+
+void History::Trim()
+{
+  // The edits furthest from the present go first, the last one is always kept
+  while(usage > capacity && undo.size() + redo.size() > 1)
+  {
+    auto& oldest = !undo.empty() ? undo : redo;
+
+    usage -= Size(oldest.front());
+    oldest.pop_front();
+  }
+}
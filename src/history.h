@@ -0,0 +1,62 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <GL/glew.h>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "codec.h"
+#include "character.h"
+
+class Character;
+
+struct TileDelta
+{
+  uint32_t tile;
+  GLubyte  before[Codec::TILE_BYTES];
+  GLubyte  after[Codec::TILE_BYTES];
+};
+
+/*
+  Undo and redo of tile edits.
+
+  Each stroke or tool commit becomes one transaction holding the planar
+  before and after images of the tiles it touched, nothing else. Undoing
+  or redoing writes those tiles back through Character, so the cost grows
+  with the tiles changed and the edits reach the journal and the texture
+  like any other. The oldest transactions are dropped to stay under the
+  memory cap.
+*/
+class History
+{
+public:
+  static void Record(size_t tile, const GLubyte* before, const GLubyte* after);
+  static void End();
+  static bool Undo();
+  static bool Redo();
+  static void Clear();
+
+  static void   SetCapacity(size_t bytes);
+  static size_t GetUsage();
+
+private:
+  typedef std::vector<TileDelta> Transaction;
+
+  static size_t Size(const Transaction& transaction);
+  static void   Trim();
+
+  static size_t capacity;
+  static size_t usage;
+
+  static std::deque<Transaction> undo;
+  static std::deque<Transaction> redo;
+
+  static Transaction                        open;
+  static std::unordered_map<uint32_t, size_t> openTiles;
+};
+
+#endif
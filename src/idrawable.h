@@ -1,6 +1,7 @@
 #ifndef IDRAWABLE_H
 #define IDRAWABLE_H
 
+#include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -23,6 +24,36 @@ struct IDrawable
     return glm::vec2(0, 0);
   }
 
+  virtual GLfloat GetZoom()
+  {
+    return 1.0f;
+  }
+
+  // Corner and size of the covered screen area, in the same space as the mouse
+  glm::vec4 GetBounds()
+  {
+    const auto zoom   = GetZoom();
+    const auto center = GetPosition() * zoom;
+    const auto extent = GetSize() * zoom;
+
+    return glm::vec4(center.x - extent.x / 2, -center.y - extent.y / 2, extent);
+  }
+
+  // Area to draw again after the mouse moved, empty when the drawable looks the same
+  virtual glm::vec4 GetDamage(glm::vec2 previousMouse, glm::vec2 mouse)
+  {
+    const auto bounds = GetBounds();
+
+    const auto contains = [&bounds](glm::vec2 point) -> bool
+      {
+        return point.x > bounds.x && point.x < bounds.x + bounds.z
+            && point.y > bounds.y && point.y < bounds.y + bounds.w;
+      };
+
+    // Surfaces shade what is under the mouse, so both the old and new spot change
+    return contains(previousMouse) || contains(mouse) ? bounds : glm::vec4(0.0f);
+  }
+
   // TODO: Fix the naming of idrawable.. maybe iupdateable / ientity?
   virtual bool Click(glm::vec2 mouse)
   {
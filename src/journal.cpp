@@ -0,0 +1,421 @@
+#include "journal.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static const GLubyte  MAGIC[]        = { 'N', 'E', 'S', 'J' };
+static const uint32_t VERSION        = 1;
+static const size_t   HEADER_SIZE    = 8;
+static const size_t   RECORD_MINIMUM = 4 + 4 + 2 + 4;
+
+const size_t Journal::batchRecords = 256;
+const double Journal::batchSeconds = 1.0;
+
+std::string          Journal::path;
+bool                 Journal::active         = false;
+int                  Journal::fd             = -1;
+uint32_t             Journal::sequence       = 0;
+std::vector<GLubyte> Journal::pending;
+size_t               Journal::pendingRecords = 0;
+std::atomic<bool>    Journal::saveFailed(false);
+std::atomic<uint32_t> Journal::failedSaves(0);
+uint32_t             Journal::retriedSaves   = 0;
+
+std::chrono::steady_clock::time_point Journal::pendingSince;
+
+static uint32_t Checksum(const GLubyte* data, size_t length)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+
+  for(size_t i = 0; i < length; i++)
+  {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+
+  return hash;
+}
+
+static void Put(std::vector<GLubyte>* out, uint32_t value, size_t bytes)
+{
+  for(size_t i = 0; i < bytes; i++) out->push_back((value >> (i * 8)) & 0xFF);
+}
+
+static uint32_t Get(const GLubyte* data, size_t bytes)
+{
+  uint32_t value = 0;
+
+  for(size_t i = 0; i < bytes; i++) value |= (uint32_t)data[i] << (i * 8);
+
+  return value;
+}
+
+static bool WriteAll(int fd, const std::vector<GLubyte>& data)
+{
+  size_t done = 0;
+
+  while(done < data.size())
+  {
+    const auto result = write(fd, data.data() + done, data.size() - done);
+    if(result <= 0) return false;
+
+    done += result;
+  }
+
+  return true;
+}
+
+static bool Sync(int fd)
+{
+#ifdef F_FULLFSYNC
+  if(fcntl(fd, F_FULLFSYNC) == 0) return true;
+#endif
+
+  return fsync(fd) == 0;
+}
+
+static std::vector<GLubyte> ReadAll(const std::string& filename)
+{
+  std::vector<GLubyte> data;
+
+  const int file = ::open(filename.c_str(), O_RDONLY);
+  if(file == -1) return data;
+
+  GLubyte block[4096];
+  ssize_t count;
+
+  while((count = read(file, block, sizeof(block))) > 0)
+  {
+    data.insert(data.end(), block, block + count);
+  }
+
+  close(file);
+
+  return data;
+}
+
+static std::vector<GLubyte> Header()
+{
+  std::vector<GLubyte> header(MAGIC, MAGIC + 4);
+
+  Put(&header, VERSION, 4);
+
+  return header;
+}
+
+AppStatus Journal::Stop()
+{
+  if(!active) return AppStatus::Success;
+
+  Flush();
+
+  // Unsaved edits stay in the journal and come back on the next start
+  const auto discard = Character::GetDirtyRuns().empty();
+  const auto journal = path;
+
+  Worker::Post([journal, discard]() -> Worker::Completion
+    {
+      if(fd != -1) close(fd);
+      fd = -1;
+
+      // Saves posted before this have finished by now, one that failed left
+      // its edits in the journal alone while their runs were no longer dirty
+      if(discard && !saveFailed) unlink(journal.c_str());
+
+      return nullptr;
+    }
+  );
+
+  active = false;
+
+  return AppStatus::Success;
+}
+
+AppStatus Journal::Update()
+{
+  if(pendingRecords == 0) return AppStatus::Success;
+
+  const std::chrono::duration<double> waited = std::chrono::steady_clock::now() - pendingSince;
+
+  if(pendingRecords >= batchRecords || waited.count() >= batchSeconds) Flush();
+
+  return AppStatus::Success;
+}
+
+void Journal::Open(std::string documentPath, bool replay)
+{
+  // Anything still pending belongs to the previous document
+  Flush();
+
+  path = documentPath + ".journal";
+  active = true;
+
+  const auto journal = path;
+
+  Worker::Post([journal, replay]() -> Worker::Completion
+    {
+      if(fd != -1) close(fd);
+
+      const auto data = replay ? ReadAll(journal) : std::vector<GLubyte>();
+
+      std::vector<JournalRecord> records;
+      const auto valid = Parse(data, &records);
+
+      fd = ::open(journal.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+
+      if(fd == -1)
+      {
+        return []() -> void { Debug::Log(LogLevel::Error, "Failed to open edit journal"); };
+      }
+
+      // A torn record at the end of a crashed session is cut off
+      if(ftruncate(fd, valid) != 0 || (valid == 0 && !WriteAll(fd, Header())))
+      {
+        Debug::Log(LogLevel::Error, "Failed to reset edit journal");
+      }
+
+      Sync(fd);
+
+      return [records]() -> void
+        {
+          if(records.empty()) return;
+
+          size_t skipped = 0;
+
+          for(const auto& x : records)
+          {
+            // Left by a larger document, or one that was since replaced
+            if(x.tile >= Character::GetTileCount())
+            {
+              skipped++;
+              continue;
+            }
+
+            GLubyte planar[Codec::TILE_BYTES];
+
+            Character::GetTile(x.tile, planar);
+
+            for(size_t i = 0; i < Codec::TILE_BYTES; i++)
+            {
+              if(x.mask & (1 << i)) planar[i] = x.planar[i];
+            }
+
+            Character::SetTile(x.tile, planar);
+
+            sequence = std::max(sequence, x.sequence + 1);
+          }
+
+          Character::Refresh();
+
+          std::stringstream stream;
+
+          stream << "Recovered "
+                 << records.size() - skipped
+                 << " journaled edits";
+
+          Debug::Log(LogLevel::Info, stream.str());
+
+          if(skipped == 0) return;
+
+          std::stringstream warning;
+
+          warning << "Skipped "
+                  << skipped
+                  << " journaled edits past the last tile";
+
+          Debug::Log(LogLevel::Warning, warning.str());
+        };
+    }
+  );
+}
+
+void Journal::Append(size_t tile, const GLubyte* before, const GLubyte* after)
+{
+  if(!active) return;
+
+  JournalRecord record = {};
+
+  record.sequence = sequence;
+  record.tile     = tile;
+
+  for(size_t i = 0; i < Codec::TILE_BYTES; i++)
+  {
+    if(before[i] != after[i]) record.mask |= 1 << i;
+
+    record.planar[i] = after[i];
+  }
+
+  if(record.mask == 0) return;
+
+  if(pendingRecords == 0) pendingSince = std::chrono::steady_clock::now();
+
+  Serialize(record, &pending);
+
+  sequence++;
+  pendingRecords++;
+}
+
+void Journal::Flush()
+{
+  if(pendingRecords == 0) return;
+
+  const auto batch = std::make_shared<std::vector<GLubyte>>();
+
+  batch->swap(pending);
+  pendingRecords = 0;
+
+  Worker::Post([batch]() -> Worker::Completion
+    {
+      if(fd == -1 || !WriteAll(fd, *batch) || !Sync(fd))
+      {
+        return []() -> void { Debug::Log(LogLevel::Error, "Failed to write edit journal"); };
+      }
+
+      return nullptr;
+    }
+  );
+}
+
+void Journal::Checkpoint(uint32_t saved)
+{
+  if(!active) return;
+
+  Flush();
+
+  const auto journal = path;
+
+  // Only the records that were not part of the save are kept
+  Worker::Post([journal, saved]() -> Worker::Completion
+    {
+      std::vector<JournalRecord> records;
+      Parse(ReadAll(journal), &records);
+
+      auto data = Header();
+
+      for(const auto& x : records)
+      {
+        if(x.sequence >= saved) Serialize(x, &data);
+      }
+
+      const auto temporary = journal + ".tmp";
+      const int  file      = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+      if(file == -1) return nullptr;
+
+      const auto written = WriteAll(file, data) && Sync(file);
+
+      close(file);
+
+      if(!written || rename(temporary.c_str(), journal.c_str()) != 0)
+      {
+        unlink(temporary.c_str());
+        return nullptr;
+      }
+
+      if(fd != -1) close(fd);
+
+      fd = ::open(journal.c_str(), O_RDWR | O_APPEND);
+
+      return nullptr;
+    }
+  );
+}
+
+void Journal::SaveResult(AppStatus status, uint32_t retried)
+{
+  if(status != AppStatus::Success)
+  {
+    failedSaves++;
+    saveFailed = true;
+
+    return;
+  }
+
+  // The edits of every failed save so far were dirty again and written here
+  if(retried == failedSaves) saveFailed = false;
+}
+
+void Journal::SaveRetried()
+{
+  retriedSaves++;
+}
+
+uint32_t Journal::GetRetriedSaves()
+{
+  return retriedSaves;
+}
+
+uint32_t Journal::GetSequence()
+{
+  return sequence;
+}
+
+double Journal::GetTimeout()
+{
+  // Negative while nothing is pending, the main loop can then wait for input alone
+  if(pendingRecords == 0) return -1.0;
+
+  const std::chrono::duration<double> waited = std::chrono::steady_clock::now() - pendingSince;
+
+  return std::max(0.0, batchSeconds - waited.count());
+}
+
+void Journal::Serialize(const JournalRecord& record, std::vector<GLubyte>* out)
+{
+  const auto start = out->size();
+
+  Put(out, record.sequence, 4);
+  Put(out, record.tile, 4);
+  Put(out, record.mask, 2);
+
+  for(size_t i = 0; i < Codec::TILE_BYTES; i++)
+  {
+    if(record.mask & (1 << i)) out->push_back(record.planar[i]);
+  }
+
+  Put(out, Checksum(out->data() + start, out->size() - start), 4);
+}
+
+size_t Journal::Parse(const std::vector<GLubyte>& data, std::vector<JournalRecord>* records)
+{
+  if( data.size() < HEADER_SIZE
+   || memcmp(data.data(), MAGIC, 4) != 0
+   || Get(data.data() + 4, 4) != VERSION
+    )
+  {
+    return 0;
+  }
+
+  size_t offset = HEADER_SIZE;
+
+  while(data.size() - offset >= RECORD_MINIMUM)
+  {
+    const auto p = data.data() + offset;
+
+    JournalRecord record = {};
+
+    record.sequence = Get(p, 4);
+    record.tile     = Get(p + 4, 4);
+    record.mask     = Get(p + 8, 2);
+
+    const auto changed = __builtin_popcount(record.mask);
+    const auto length  = RECORD_MINIMUM + changed;
+
+    if(data.size() - offset < length) break;
+
+    if(Get(p + length - 4, 4) != Checksum(p, length - 4)) break;
+
+    for(size_t i = 0, j = 0; i < Codec::TILE_BYTES; i++)
+    {
+      if(record.mask & (1 << i)) record.planar[i] = p[10 + j++];
+    }
+
+    records->push_back(record);
+
+    offset += length;
+  }
+
+  return offset;
+}
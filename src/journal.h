@@ -0,0 +1,82 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+
+#include "appstatus.h"
+#include "debug.h"
+#include "codec.h"
+#include "worker.h"
+#include "character.h"
+
+class Character;
+
+struct JournalRecord
+{
+  uint32_t sequence;
+  uint32_t tile;
+  uint16_t mask;
+  GLubyte  planar[Codec::TILE_BYTES];
+};
+
+/*
+  Append-only log of committed tile edits, kept next to the document.
+
+  Every record holds the plane bytes of one tile that an edit changed, so
+  replaying a record more than once is harmless. Records are written and
+  synced in batches on the worker, replayed when the document is opened,
+  and dropped once a save has put them into the document itself.
+*/
+class Journal
+{
+public:
+  static AppStatus Stop();
+  static AppStatus Update();
+
+  static void Open(std::string documentPath, bool replay);
+  static void Append(size_t tile, const GLubyte* before, const GLubyte* after);
+  static void Flush();
+  static void Checkpoint(uint32_t sequence);
+
+  // Called on the worker by every save job, with what the save returned and
+  // how many failed saves had their tiles marked dirty again when it was posted
+  static void SaveResult(AppStatus status, uint32_t retried);
+
+  // Called once a failed save has marked its tiles dirty again
+  static void SaveRetried();
+
+  static uint32_t GetRetriedSaves();
+
+  static uint32_t GetSequence();
+  static double   GetTimeout();
+
+private:
+  static void Serialize(const JournalRecord& record, std::vector<GLubyte>* out);
+
+  static size_t Parse(const std::vector<GLubyte>& data, std::vector<JournalRecord>* records);
+
+  static const size_t batchRecords;
+  static const double batchSeconds;
+
+  static std::string           path;
+  static bool                  active;
+  static int                   fd;
+  static uint32_t              sequence;
+  static std::vector<GLubyte>  pending;
+  static size_t                pendingRecords;
+  static std::atomic<bool>     saveFailed;
+  static std::atomic<uint32_t> failedSaves;
+  static uint32_t              retriedSaves;
+
+  static std::chrono::steady_clock::time_point pendingSince;
+};
+
+#endif
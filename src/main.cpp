@@ -3,8 +3,10 @@
 #include "app.h"
 #include "debug.h"
 
-int main()
-{    
+int main(int argc, char** argv)
+{
+  if(argc > 1) Media::SetCharacterPath(argv[1]);
+
   auto status = App::Start();
 
   Debug::LogStatus(status);
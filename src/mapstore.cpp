@@ -0,0 +1,247 @@
+#include "mapstore.h"
+
+#include <algorithm>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static const GLubyte  MAGIC[]     = { 'N', 'E', 'S', 'M' };
+static const uint32_t VERSION     = 1;
+static const size_t   HEADER_SIZE = 16;
+
+static void Put(GLubyte* out, uint32_t value)
+{
+  for(size_t i = 0; i < 4; i++) out[i] = (value >> (i * 8)) & 0xFF;
+}
+
+static uint32_t Get(const GLubyte* data)
+{
+  uint32_t value = 0;
+
+  for(size_t i = 0; i < 4; i++) value |= (uint32_t)data[i] << (i * 8);
+
+  return value;
+}
+
+MapStore::MapStore()
+  : fd(-1)
+  , screens(0)
+  , mirroring(FourScreenMirroring)
+  , capacity(16)
+{
+}
+
+MapStore::~MapStore()
+{
+  Close();
+}
+
+AppStatus MapStore::Open(std::string newPath, glm::ivec2 newScreens)
+{
+  Close();
+
+  path = newPath;
+  fd   = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+  if(fd == -1) return AppStatus::FailureMapLoad;
+
+  struct stat info;
+
+  if(fstat(fd, &info) != 0) return Fail();
+
+  // Only a file that is still empty becomes a new map, anything else is left alone
+  if(info.st_size == 0) return Create(newScreens);
+
+  GLubyte header[HEADER_SIZE];
+
+  if( pread(fd, header, HEADER_SIZE, 0) != (ssize_t)HEADER_SIZE
+   || !std::equal(MAGIC, MAGIC + 4, header)
+   || Get(header + 4) != VERSION
+    )
+  {
+    return Fail();
+  }
+
+  const auto wide = Get(header + 8);
+  const auto high = Get(header + 12);
+
+  if(wide < 1 || high < 1 || wide > INT32_MAX || high > INT32_MAX) return Fail();
+
+  if((size_t)info.st_size != HEADER_SIZE + (size_t)wide * high * CHUNK_BYTES) return Fail();
+
+  screens = glm::ivec2(wide, high);
+
+  return AppStatus::Success;
+}
+
+AppStatus MapStore::Create(glm::ivec2 newScreens)
+{
+  // A new map is all zero chunks, the file system keeps them sparse
+  screens = glm::max(newScreens, glm::ivec2(1));
+
+  GLubyte header[HEADER_SIZE];
+
+  std::copy(MAGIC, MAGIC + 4, header);
+  Put(header + 4, VERSION);
+  Put(header + 8, screens.x);
+  Put(header + 12, screens.y);
+
+  const auto bytes = HEADER_SIZE + (size_t)screens.x * screens.y * CHUNK_BYTES;
+
+  if(pwrite(fd, header, HEADER_SIZE, 0) != (ssize_t)HEADER_SIZE || ftruncate(fd, bytes) != 0) return Fail();
+
+  return AppStatus::Success;
+}
+
+AppStatus MapStore::Fail()
+{
+  close(fd);
+
+  fd      = -1;
+  screens = glm::ivec2(0);
+
+  return AppStatus::FailureMapLoad;
+}
+
+void MapStore::Close()
+{
+  if(fd == -1) return;
+
+  if(!Flush()) Debug::Log(LogLevel::Error, "Failed to write back map " + path);
+
+  close(fd);
+
+  fd = -1;
+
+  chunks.clear();
+  lookup.clear();
+}
+
+bool MapStore::Flush()
+{
+  if(fd == -1) return true;
+
+  auto result = true;
+
+  for(auto& x : chunks) result = WriteBack(x) && result;
+
+  return result && fsync(fd) == 0;
+}
+
+const GLubyte* MapStore::GetChunk(glm::ivec2 screen)
+{
+  const auto chunk = Page(screen);
+
+  return chunk ? chunk->data.data() : nullptr;
+}
+
+GLubyte* MapStore::GetWritableChunk(glm::ivec2 screen)
+{
+  const auto chunk = Page(screen);
+  if(chunk == nullptr) return nullptr;
+
+  chunk->edited = true;
+
+  return chunk->data.data();
+}
+
+glm::ivec2 MapStore::Resolve(glm::ivec2 screen) const
+{
+  // Mirrored screens share the data of the first of their pair
+  switch(mirroring)
+  {
+    case Mirroring::HorizontalMirroring: return glm::ivec2(screen.x & ~1, screen.y);
+    case Mirroring::VerticalMirroring:   return glm::ivec2(screen.x, screen.y & ~1);
+    default:                             return screen;
+  }
+}
+
+void MapStore::SetMirroring(Mirroring newMirroring)
+{
+  mirroring = newMirroring;
+}
+
+void MapStore::SetCapacity(size_t chunks)
+{
+  capacity = std::max<size_t>(chunks, 1);
+}
+
+Mirroring MapStore::GetMirroring() const
+{
+  return mirroring;
+}
+
+glm::ivec2 MapStore::GetScreens() const
+{
+  return screens;
+}
+
+size_t MapStore::GetResidentCount() const
+{
+  return chunks.size();
+}
+
+MapStore::Chunk* MapStore::Page(glm::ivec2 screen)
+{
+  if(fd == -1) return nullptr;
+
+  const auto resolved = glm::clamp(Resolve(screen), glm::ivec2(0), screens - 1);
+  const auto index    = (size_t)resolved.y * screens.x + resolved.x;
+
+  const auto found = lookup.find(index);
+
+  if(found != lookup.end())
+  {
+    chunks.splice(chunks.begin(), chunks, found->second);
+
+    return &chunks.front();
+  }
+
+  // The least recently used chunk makes room, its node is reused as is
+  if(chunks.size() >= capacity)
+  {
+    auto& last = chunks.back();
+
+    if(!WriteBack(last))
+    {
+      Debug::Log(LogLevel::Error, "Failed to write back map " + path);
+      return nullptr;
+    }
+
+    lookup.erase(last.index);
+    chunks.splice(chunks.begin(), chunks, std::prev(chunks.end()));
+  }
+  else
+  {
+    chunks.emplace_front();
+  }
+
+  auto& chunk = chunks.front();
+
+  chunk.index  = index;
+  chunk.edited = false;
+
+  const auto offset = HEADER_SIZE + index * CHUNK_BYTES;
+  const auto read   = pread(fd, chunk.data.data(), CHUNK_BYTES, offset);
+
+  // Past the end of a short file the chunk is empty
+  std::fill(chunk.data.begin() + std::max<ssize_t>(read, 0), chunk.data.end(), 0);
+
+  lookup[index] = chunks.begin();
+
+  return &chunk;
+}
+
+bool MapStore::WriteBack(Chunk& chunk)
+{
+  if(!chunk.edited) return true;
+
+  const auto offset = HEADER_SIZE + chunk.index * CHUNK_BYTES;
+
+  if(pwrite(fd, chunk.data.data(), CHUNK_BYTES, offset) != (ssize_t)CHUNK_BYTES) return false;
+
+  chunk.edited = false;
+
+  return true;
+}
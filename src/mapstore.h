@@ -0,0 +1,83 @@
+#ifndef MAPSTORE_H
+#define MAPSTORE_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <array>
+#include <cstdint>
+
+#include "appstatus.h"
+#include "debug.h"
+
+// Which screens of a 2 x 2 block show the same data, as the cartridge wires the PPU
+enum Mirroring
+{
+  HorizontalMirroring = 0,
+  VerticalMirroring,
+  FourScreenMirroring
+};
+
+/*
+  Map of many screens kept in a backing file, one fixed size chunk per
+  screen in PPU layout.
+
+  Only a few chunks are resident at a time. The least recently used one is
+  written back if it was edited and its memory is reused for the chunk
+  being paged in, so memory stays the same however large the map is.
+  Pointers to chunk data are valid until the next chunk is paged in.
+*/
+class MapStore
+{
+public:
+  static constexpr size_t CHUNK_BYTES = 32 * 30 + 64;
+
+  MapStore();
+  ~MapStore();
+
+  // An existing map keeps its own size, an empty or missing file becomes a
+  // new map of the given size, anything else fails and is left untouched
+  AppStatus Open(std::string path, glm::ivec2 screens);
+  void      Close();
+  bool      Flush();
+
+  const GLubyte* GetChunk(glm::ivec2 screen);
+  GLubyte*       GetWritableChunk(glm::ivec2 screen);
+
+  // The screen whose data is shown at a map position
+  glm::ivec2 Resolve(glm::ivec2 screen) const;
+
+  void SetMirroring(Mirroring newMirroring);
+  void SetCapacity(size_t chunks);
+
+  Mirroring  GetMirroring() const;
+  glm::ivec2 GetScreens() const;
+  size_t     GetResidentCount() const;
+
+private:
+  struct Chunk
+  {
+    size_t                           index;
+    bool                             edited;
+    std::array<GLubyte, CHUNK_BYTES> data;
+  };
+
+  AppStatus Create(glm::ivec2 newScreens);
+  AppStatus Fail();
+
+  Chunk* Page(glm::ivec2 screen);
+  bool   WriteBack(Chunk& chunk);
+
+  std::string path;
+  int         fd;
+  glm::ivec2  screens;
+  Mirroring   mirroring;
+  size_t      capacity;
+
+  std::list<Chunk>                                        chunks; // Most recently used first
+  std::unordered_map<size_t, std::list<Chunk>::iterator> lookup;
+};
+
+#endif
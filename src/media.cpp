@@ -2,7 +2,75 @@
 
 std::map<std::string, GLuint> Media::shaderPrograms;
 
-const auto bankSize = pow(128, 2);
+const std::string Media::shaderCacheDirectory = "shadercache";
+
+std::string Media::characterPath   = "data.chr";
+size_t      Media::characterOffset = 0;
+size_t      Media::characterSize   = 0;
+bool        Media::characterBacked = false;
+bool        Media::characterPending = false;
+
+static bool Sync(int fd)
+{
+#ifdef F_FULLFSYNC
+  if(fcntl(fd, F_FULLFSYNC) == 0) return true;
+#endif
+
+  return fsync(fd) == 0;
+}
+
+// The rename itself only lasts once the directory that holds it is synced
+static bool SyncDirectory(const std::string& path)
+{
+  const auto slash     = path.find_last_of('/');
+  const auto directory = slash == std::string::npos ? std::string(".") : path.substr(0, slash + 1);
+
+  const int fd = open(directory.c_str(), O_RDONLY);
+  if(fd == -1) return false;
+
+  const auto result = Sync(fd);
+
+  close(fd);
+
+  return result;
+}
+
+// Written next to the file, synced and moved over it, so a crash leaves
+// either the old or the new contents
+static bool ReplaceFile(const std::string& path, const std::vector<std::pair<const void*, size_t>>& parts)
+{
+  const auto temporary = path + ".tmp";
+
+  const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(fd == -1) return false;
+
+  auto written = true;
+
+  for(const auto& x : parts)
+  {
+    size_t done = 0;
+
+    while(written && done < x.second)
+    {
+      const auto result = write(fd, (const GLubyte*)x.first + done, x.second - done);
+
+      written = result > 0;
+      done   += written ? result : 0;
+    }
+  }
+
+  written = written && Sync(fd);
+
+  close(fd);
+
+  if(!written || rename(temporary.c_str(), path.c_str()) != 0)
+  {
+    remove(temporary.c_str());
+    return false;
+  }
+
+  return SyncDirectory(path);
+}
 
 AppStatus Media::Start()
 {
@@ -22,10 +90,15 @@ AppStatus Media::Start()
 
 AppStatus Media::Stop()
 {
+  // Programs are shared by everything that loaded the same shaders, they go once here
+  for(const auto& x : shaderPrograms) glDeleteProgram(x.second);
+
+  shaderPrograms.clear();
+
   return AppStatus::Success;
 }
 
-std::pair<AppStatus, GLuint> Media::LoadTexture(std::string path)
+std::pair<AppStatus, Image> Media::LoadImage(std::string path)
 {
   ILuint id = 0;
   
@@ -44,50 +117,85 @@ std::pair<AppStatus, GLuint> Media::LoadTexture(std::string path)
 
     Debug::Log(LogLevel::Error, stream.str());
     
-    return std::make_pair(AppStatus::FailureTextureLoad, 0);
+    return std::make_pair(AppStatus::FailureTextureLoad, Image());
   }
 
   if(ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE) != IL_TRUE)
   {
     Debug::Log(LogLevel::Error, "Failed to convert image with IL");
-    return std::make_pair(AppStatus::FailureTextureLoad, 0);
+    return std::make_pair(AppStatus::FailureTextureLoad, Image());
   }
 
-  auto data   = (GLuint*)ilGetData();
-  auto width  = (GLuint)ilGetInteger(IL_IMAGE_WIDTH);
-  auto height = (GLuint)ilGetInteger(IL_IMAGE_HEIGHT);
+  Image image;
 
-  GLuint textureId;
-  
-  glGenTextures(1, &textureId);
-  glBindTexture(GL_TEXTURE_2D, textureId);
-  
-  glTexImage2D
-    ( GL_TEXTURE_2D, 0, GL_RGBA, width, height
-    , 0, GL_RGBA, GL_UNSIGNED_BYTE, data
-    );
+  image.width  = (GLuint)ilGetInteger(IL_IMAGE_WIDTH);
+  image.height = (GLuint)ilGetInteger(IL_IMAGE_HEIGHT);
 
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glBindTexture(GL_TEXTURE_2D, 0);
+  const auto data = (const GLubyte*)ilGetData();
+
+  image.rgba.assign(data, data + image.width * image.height * 4);
 
   ilDeleteImages(1, &id);
   
-  return std::make_pair(AppStatus::Success, textureId);
+  return std::make_pair(AppStatus::Success, image);
+}
+
+void Media::AllocateByteTexture(GLsizei width, GLsizei height)
+{
+  // Immutable storage is core only from GL 4.2
+  if(GLEW_ARB_texture_storage)
+  {
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8UI, width, height);
+  }
+  else
+  {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+  }
 }
 
 std::pair<AppStatus, GLuint> Media::LoadShaderProgram(std::vector<std::string> filenames)
 {
-  auto existing = shaderPrograms.find(filenames.at(0));
+  std::string key;
+
+  for(const auto& x : filenames) key += x + ";";
+
+  auto existing = shaderPrograms.find(key);
   if(existing != shaderPrograms.end()) return std::make_pair(Success, existing->second);
-  
+
+  std::vector<std::string> sources;
+
+  for(const auto& x : filenames)
+  {
+    const auto sourceResult = ReadShaderSource(x);
+    if(sourceResult.first != AppStatus::Success) return std::make_pair(sourceResult.first, 0);
+
+    sources.push_back(sourceResult.second);
+  }
+
+  // A binary is only reused by the same driver for the exact same sources
+  std::stringstream cachePath;
+
+  cachePath << shaderCacheDirectory
+            << "/"
+            << std::hex
+            << HashShaderSources(filenames, sources)
+            << ".bin";
+
+  const auto cached = LoadProgramBinary(cachePath.str());
+
+  if(cached != 0)
+  {
+    shaderPrograms[key] = cached;
+    return std::make_pair(AppStatus::Success, cached);
+  }
+
   GLuint programId = glCreateProgram();
 
   std::vector<GLuint> shaders;
   
-  for(auto filename : filenames)
+  for(size_t i = 0; i < filenames.size(); i++)
   {
-    auto shaderResult = LoadShader(filename);
+    auto shaderResult = LoadShader(filenames[i], sources[i]);
         
     if(shaderResult.first != AppStatus::Success)
     {
@@ -98,6 +206,11 @@ std::pair<AppStatus, GLuint> Media::LoadShaderProgram(std::vector<std::string> f
     shaders.push_back(shaderResult.second);
   }
 
+  if(GLEW_ARB_get_program_binary)
+  {
+    glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+
   glLinkProgram(programId);
 
   GLint       result        = GL_FALSE;
@@ -125,11 +238,32 @@ std::pair<AppStatus, GLuint> Media::LoadShaderProgram(std::vector<std::string> f
     glDetachShader(programId, shader);
     glDeleteShader(shader);
   }
+
+  SaveProgramBinary(cachePath.str(), programId);
+
+  shaderPrograms[key] = programId;
     
   return std::make_pair(AppStatus::Success, programId);
 }
 
-std::pair<AppStatus, GLuint> Media::LoadShader(std::string filename)
+std::pair<AppStatus, std::string> Media::ReadShaderSource(std::string filename)
+{
+  std::ifstream     sourceStream(filename, std::ios::in);
+  std::stringstream stringStream;
+
+  if(!sourceStream.is_open())
+  {
+    return std::make_pair(AppStatus::FailureShaderLoad, std::string());
+  }
+
+  stringStream << sourceStream.rdbuf();
+
+  sourceStream.close();
+
+  return std::make_pair(AppStatus::Success, stringStream.str());
+}
+
+std::pair<AppStatus, GLuint> Media::LoadShader(std::string filename, std::string source)
 {
   auto modeString = filename.substr(filename.find("."));
 
@@ -145,20 +279,6 @@ std::pair<AppStatus, GLuint> Media::LoadShader(std::string filename)
 
   GLuint shaderId = glCreateShader(modeId);
 
-  std::ifstream     sourceStream(filename, std::ios::in);
-  std::stringstream stringStream;
-
-  if(!sourceStream.is_open())
-  {
-    return std::make_pair(AppStatus::FailureShaderLoad, 0);
-  }
-
-  stringStream << sourceStream.rdbuf();
-    
-  std::string source = stringStream.str();
-
-  sourceStream.close();
-
   GLint       result        = GL_FALSE;
   int         infoLogLength = 0;
   const char* sourcePointer = source.c_str();
@@ -185,6 +305,112 @@ std::pair<AppStatus, GLuint> Media::LoadShader(std::string filename)
   return std::make_pair(AppStatus::Success, shaderId);
 }
 
+uint64_t Media::HashShaderSources
+  ( const std::vector<std::string>& filenames
+  , const std::vector<std::string>& sources
+  )
+{
+  std::vector<std::string> parts = filenames;
+
+  parts.insert(parts.end(), sources.begin(), sources.end());
+
+  const GLenum driverStrings[] =
+    { GL_VENDOR
+    , GL_RENDERER
+    , GL_VERSION
+    , GL_SHADING_LANGUAGE_VERSION
+    };
+
+  for(const auto x : driverStrings)
+  {
+    const auto value = glGetString(x);
+
+    parts.push_back(value != nullptr ? (const char*)value : "");
+  }
+
+  // FNV-1a, each part is terminated so that moving text between parts changes the hash
+  uint64_t hash = 14695981039346656037ull;
+
+  for(const auto& part : parts)
+  {
+    for(const auto c : part) hash = (hash ^ (uint8_t)c) * 1099511628211ull;
+
+    hash = (hash ^ 0xFF) * 1099511628211ull;
+  }
+
+  return hash;
+}
+
+GLuint Media::LoadProgramBinary(std::string path)
+{
+  if(!GLEW_ARB_get_program_binary) return 0;
+
+  std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+
+  if(!file.is_open()) return 0;
+
+  const std::streamoff size = file.tellg();
+
+  if(size <= (std::streamoff)sizeof(GLenum)) return 0;
+
+  GLenum format = 0;
+
+  std::vector<char> binary(size - sizeof(format));
+
+  file.seekg(0);
+  file.read((char*)&format, sizeof(format));
+  file.read(binary.data(), binary.size());
+
+  if(!file.good()) return 0;
+
+  const GLuint programId = glCreateProgram();
+
+  glProgramBinary(programId, format, binary.data(), binary.size());
+
+  GLint result = GL_FALSE;
+
+  glGetProgramiv(programId, GL_LINK_STATUS, &result);
+
+  // A driver update can reject old binaries, the program is compiled again
+  if(result != GL_TRUE)
+  {
+    glDeleteProgram(programId);
+    remove(path.c_str());
+
+    return 0;
+  }
+
+  return programId;
+}
+
+void Media::SaveProgramBinary(std::string path, GLuint programId)
+{
+  if(!GLEW_ARB_get_program_binary) return;
+
+  GLint length = 0;
+
+  glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length);
+
+  if(length <= 0) return;
+
+  std::vector<char> binary(length);
+  GLenum            format = 0;
+
+  glGetProgramBinary(programId, length, &length, &format, binary.data());
+
+  mkdir(shaderCacheDirectory.c_str(), 0755);
+
+  const std::vector<std::pair<const void*, size_t>> parts =
+    { { &format, sizeof(format) }
+    , { binary.data(), (size_t)length }
+    };
+
+  if(!ReplaceFile(path, parts))
+  {
+    Debug::Log(LogLevel::Warning, "Failed to cache shader program binary");
+  }
+}
+
 // std::pair<AppStatus, std::vector<GLubyte>> Media::LoadSamples()
 // {
 //     return std::make_pair(AppStatus::Success, std::vector<GLubyte>());
@@ -192,188 +418,393 @@ std::pair<AppStatus, GLuint> Media::LoadShader(std::string filename)
 
 AppStatus Media::SaveSamples()
 {
-  auto samples = Samples::GetSamples();
+  // The samples can keep changing meanwhile, edits copy them first
+  const auto samples = Samples::GetSnapshot();
+
+  Worker::Post([samples]() -> Worker::Completion
+    {
+      std::ofstream file("samples.sam", std::ios::out | std::ios::binary | std::ios::trunc);
 
-  std::ofstream file("samples.sam", std::ios::out | std::ios::binary | std::ios::trunc);
+      if(!file.is_open()) return nullptr;
 
-  if(!file.is_open()) return AppStatus::Success;
+      Debug::Log(LogLevel::Info, "Writing samples to file...");
 
-  Debug::Log(LogLevel::Info, "Writing samples to file...");
+      std::vector<uint8_t> buffer(samples->begin(), samples->end());
 
-  for(const auto &sample : *samples)
-  {
-    file.write((char*)&sample, sizeof(uint8_t));
-  }
+      file.write((char*)buffer.data(), buffer.size());
 
-  Debug::Log(LogLevel::Info, "Finished writing sample file!");
+      file.close();
 
-  file.close();
+      return []() -> void { Debug::Log(LogLevel::Info, "Finished writing sample file!"); };
+    }
+  );
     
   return AppStatus::Success;
 }
 
 AppStatus Media::LoadSamples()
 {
-  std::vector<GLuint> samples;
+  Worker::Post([]() -> Worker::Completion
+    {
+      std::ifstream file("samples.sam", std::ios::in | std::ios::binary);
 
-  std::ifstream file("samples.sam", std::ios::in | std::ios::binary);
+      if(!file.is_open()) return nullptr;
 
-  if(!file.is_open()) return AppStatus::Success;
+      Debug::Log(LogLevel::Info, "Reading samples from file...");
 
-  Debug::Log(LogLevel::Info, "Reading samples from file...");
+      const auto samples = std::make_shared<std::vector<GLuint>>();
 
-  uint8_t sample = 0x00;
+      uint8_t sample = 0x00;
     
-  while(file.read((char*)&sample, 1))
-  {
-    samples.push_back(sample);
-  }
+      while(file.read((char*)&sample, 1))
+      {
+        samples->push_back(sample);
+      }
 
-  Debug::Log(LogLevel::Info, "Finished reading samples from file!");
-    
-  file.close();
+      file.close();
 
-  Samples::SetSamples(std::move(samples));
+      return [samples]() -> void
+        {
+          Samples::SetSamples(std::move(*samples));
+          Debug::Log(LogLevel::Info, "Finished reading samples from file!");
+        };
+    }
+  );
 
   return AppStatus::Success;
 }
 
 AppStatus Media::SaveCharacter()
 {
-  const auto character = Character::GetCharacter();
+  if(characterPending)
+  {
+    Debug::Log(LogLevel::Warning, "Character is still loading, not saving");
+    return AppStatus::Success;
+  }
 
-  std::ofstream file("data.chr", std::ios::out | std::ios::binary | std::ios::trunc);
+  // Once the file holds the loaded character only edited tiles are written
+  if(characterBacked) return SaveCharacterTiles();
 
-  if(!file.is_open()) return AppStatus::Success;
+  const auto path     = characterPath;
+  const auto runs     = Character::GetDirtyRuns();
+  const auto snapshot = std::make_shared<const BankSnapshot>(Character::GetSnapshot());
+  const auto retried  = Journal::GetRetriedSaves();
 
-  Debug::Log(LogLevel::Info, "Writing character to file...");
+  Character::ClearDirty();
 
-  for(auto bank = 0; bank < 2; bank++)
-  {
-    const auto bo = bank * bankSize; // Bank offset
-      
-    for(auto ty = 0; ty < 16; ty++) // 16 x 16 Tiles = 1 bank
+  Worker::Post([path, runs, snapshot, retried]() -> Worker::Completion
     {
-      for(auto tx = 0; tx < 16; tx++)
-      {
-        const auto to = ty * 128 * 8 + tx * 8; // Tile offset
-                
-        for(auto pass = 0; pass < 2; pass++) // Two passes to register color bits
+      Debug::Log(LogLevel::Info, "Writing character to file...");
+
+      const auto status = WriteFile(path, *snapshot);
+
+      Journal::SaveResult(status, retried);
+
+      const auto size = snapshot->GetTileCount() * Codec::TILE_BYTES;
+
+      return [path, runs, size, status]() -> void
         {
-          for(auto y = 0; y < 8; y++) // 8 rows per tile
+          if(status != AppStatus::Success)
           {
-            uint8_t row = 0x00; // Byte buffer
-                        
-            for(auto x = 0; x < 8; x++) // 8 columns per tile
-            {
-              const auto p = bo + to + y * 128 + x;
-
-              // Read number into byte buffer here
-              switch(character[p])
-              {
-              case 1:
-                if(pass == 0)
-                {
-                  row |= 0b10000000 >> x;
-                }
-                break;
-
-              case 2:
-                if(pass == 1)
-                {
-                  row |= 0b10000000 >> x;
-                }
-                break;
-
-              case 3:
-                row |= 0b10000000 >> x;
-                break;
-
-              default:
-                break;
-              }
-            }
-                      
-            file.write((char*)&row, sizeof(uint8_t));
+            for(const auto& x : runs) Character::MarkDirty(x.first, x.second);
+            Journal::SaveRetried();
+
+            Debug::LogStatus(status);
+            return;
           }
-        }
-      }
-    }
-  }
-    
-  Debug::Log(LogLevel::Info, "Finished writing character file!");
 
-  file.close();
+          // Later saves to the same file only write changed tiles
+          if(path == characterPath)
+          {
+            characterBacked = true;
+            characterOffset = 0;
+            characterSize   = size;
+
+            // The file now holds every edit, journaling starts afresh
+            Journal::Open(path, false);
+          }
+
+          Debug::Log(LogLevel::Info, "Finished writing character file!");
+        };
+    }
+  );
     
   return AppStatus::Success;
 }
 
-AppStatus Media::LoadCharacter()
+AppStatus Media::SaveCharacterTiles()
 {
-  std::vector<GLubyte> buffer;
-  std::vector<GLubyte> character(bankSize * 2);
-    
-  std::ifstream file("data.chr", std::ios::in | std::ios::binary);
+  const auto dirty = Character::GetDirtyRuns();
 
-  if(!file.is_open()) return AppStatus::Success;
+  if(dirty.empty())
+  {
+    Debug::Log(LogLevel::Info, "No changes to write");
+    return AppStatus::Success;
+  }
 
-  Debug::Log(LogLevel::Info, "Reading character from file...");
+  // A ROM has a fixed amount of CHR-ROM, a bare character file may grow
+  const auto isRom = characterOffset > 0;
+  const auto limit = isRom ? characterSize / Codec::TILE_BYTES : Character::GetTileCount();
+  const auto runs  = std::make_shared<std::vector<std::pair<size_t, size_t>>>();
 
-  for(auto tile = 0; tile < 512; tile++) // 512 tiles
+  for(const auto& x : dirty)
   {
-    std::vector<GLubyte> tileBuffer(64); // 64 pixels (8 x 8) 
-        
-    for(auto pass = 0; pass < 2; pass++) // 16 rows define 1 tile, 1 pass is 8 rows
+    if(x.first >= limit) break;
+
+    runs->push_back(std::make_pair(x.first, std::min(x.second, limit - x.first)));
+  }
+
+  // The worker reads the tiles from the snapshot, later edits copy their bank
+  const auto snapshot = std::make_shared<const BankSnapshot>(Character::GetSnapshot());
+
+  Character::ClearDirty();
+
+  const auto path     = characterPath;
+  const auto offset   = characterOffset;
+  const auto minimum  = isRom ? 0 : limit * Codec::TILE_BYTES;
+  const auto sequence = Journal::GetSequence();
+  const auto retried  = Journal::GetRetriedSaves();
+
+  // Journaled edits reach the disk before the tiles themselves
+  Journal::Flush();
+
+  Worker::Post([path, offset, minimum, sequence, retried, runs, snapshot]() -> Worker::Completion
     {
-      for(auto y = 0; y < 8; y++) // Rows
-      {
-        uint8_t row = 0x00;
-                
-        file.read((char*)&row, 1); // Read 1 byte
-                
-        for(auto x = 0; x < 8; x++) // Columns
+      Debug::Log(LogLevel::Info, "Writing changed tiles to file...");
+
+      const auto status = WriteTiles(path, offset, minimum, *snapshot, *runs);
+
+      Journal::SaveResult(status, retried);
+
+      return [runs, status, sequence]() -> void
         {
-          if(pass == 0 && row & (0b10000000 >> x))
+          if(status != AppStatus::Success)
           {
-            tileBuffer[y * 8 + x] = 1;
+            for(const auto& x : *runs) Character::MarkDirty(x.first, x.second);
+            Journal::SaveRetried();
+
+            Debug::LogStatus(status);
+            return;
           }
-          else if(pass == 1 && row & (0b10000000 >> x))
+
+          Journal::Checkpoint(sequence);
+
+          size_t written = 0;
+
+          for(const auto& x : *runs) written += x.second;
+
+          std::stringstream stream;
+
+          stream << "Finished writing "
+                 << written
+                 << " changed tiles!";
+
+          Debug::Log(LogLevel::Info, stream.str());
+        };
+    }
+  );
+
+  return AppStatus::Success;
+}
+
+void Media::SetCharacterPath(std::string path)
+{
+  characterPath   = path;
+  characterBacked = false;
+}
+
+AppStatus Media::LoadCharacter()
+{
+  if(characterPending) return AppStatus::Success;
+
+  characterPending = true;
+
+  const auto path = characterPath;
+
+  Worker::Post([path]() -> Worker::Completion
+    {
+      const auto file = MapCharacter(path);
+
+      return [path, file]() -> void
+        {
+          characterPending = false;
+
+          if(file.status != AppStatus::Success)
           {
-            if(tileBuffer[y * 8 + x] == 0)
-            {
-              tileBuffer[y * 8 + x] = 2;
-            }
-            else
-            {
-              tileBuffer[y * 8 + x] = 3;
-            }
+            Debug::LogStatus(file.status);
+            return;
           }
-        }
-      }
+
+          characterPath   = path;
+          characterOffset = file.offset;
+          characterSize   = file.size;
+          characterBacked = true;
+
+          Character::SetCharacter(file.chr, file.size / Codec::TILE_BYTES);
+
+          // Edits that never made it into the file are replayed
+          Journal::Open(path, true);
+
+          Debug::Log(LogLevel::Info, "Finished reading character file!");
+        };
     }
+  );
+    
+  return AppStatus::Success;
+}
 
-    // Insert 1 full tile
-    buffer.insert(buffer.end(), tileBuffer.begin(), tileBuffer.end());
+CharacterFile Media::MapCharacter(std::string path)
+{
+  CharacterFile result = { AppStatus::FailureCharacterLoad, nullptr, 0, 0 };
+
+  const int fd = open(path.c_str(), O_RDONLY);
+
+  if(fd == -1) return result;
+
+  struct stat info;
+
+  if(fstat(fd, &info) == -1)
+  {
+    close(fd);
+    return result;
   }
 
-  // Read 1 bank of tiles into the character, changing the format for rendering
-  for(auto tile = 0; tile < 512; tile++)
+  Debug::Log(LogLevel::Info, "Reading character from file...");
+
+  const size_t length = info.st_size;
+
+  if(length == 0)
   {
-    const auto bo = tile * 64; // Offset for each tile in the buffer
-    const auto co = floor(tile / 16) * 128 * 8 + tile % 16 * 8; // Character offset
-      
-    for(auto i = 0; i < 64; i++)
+    close(fd);
+
+    result.status = AppStatus::Success;
+    return result;
+  }
+
+  const auto data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if(data == MAP_FAILED)
+  {
+    Debug::Log(LogLevel::Error, "Failed to map character file");
+    return result;
+  }
+
+  // The mapping lives as long as the character keeps it as its source
+  const std::shared_ptr<const GLubyte> mapping
+    ( (const GLubyte*)data
+    , [length](const GLubyte* p) -> void { munmap((void*)p, length); }
+    );
+
+  size_t chrOffset = 0;
+  size_t chrSize   = length;
+
+  if(Rom::IsRom(mapping.get(), length))
+  {
+    const auto header = Rom::ParseHeader(mapping.get(), length);
+
+    if(header.first != AppStatus::Success || header.second.chrSize == 0)
     {
-      const auto z  = co + floor(i / 8) * 128 + i % 8;
-      character[z]  = buffer[bo + i];
+      Debug::Log(LogLevel::Error, "ROM has no readable CHR-ROM");
+
+      result.status = AppStatus::FailureRomHeader;
+      return result;
     }
+
+    std::stringstream stream;
+
+    stream << (header.second.isNes2 ? "NES 2.0" : "iNES")
+           << " ROM, mapper "
+           << header.second.mapper
+           << ", "
+           << header.second.chrSize / 1024
+           << " KB CHR-ROM";
+
+    Debug::Log(LogLevel::Info, stream.str());
+
+    chrOffset = header.second.chrOffset;
+    chrSize   = header.second.chrSize;
   }
-    
-  Debug::Log(LogLevel::Info, "Finished reading character file!");
 
-  file.close();
+  // Banks page in from the mapping on demand, a trailing partial tile is ignored
+  result.status = AppStatus::Success;
+  result.chr    = std::shared_ptr<const GLubyte>(mapping, mapping.get() + chrOffset);
+  result.offset = chrOffset;
+  result.size   = chrSize;
+
+  return result;
+}
+
+AppStatus Media::WriteFile(std::string path, const BankSnapshot& snapshot)
+{
+  // Moved over the original, so a mapping of the old file stays valid and
+  // a failed write leaves the old file intact
+  std::vector<std::pair<const void*, size_t>> parts;
+
+  for(size_t i = 0; i < snapshot.GetTileCount(); i += BankStore::BANK_TILES)
+  {
+    const auto bank = snapshot.GetTiles(i, BankStore::BANK_TILES);
+
+    parts.push_back(std::make_pair(bank.data(), bank.size()));
+  }
+
+  if(!ReplaceFile(path, parts)) return AppStatus::FailureCharacterSave;
 
-  Character::SetCharacter(std::move(character));
-    
   return AppStatus::Success;
 }
+
+AppStatus Media::WriteTiles
+  ( std::string path
+  , size_t offset
+  , size_t minimumSize
+  , const BankSnapshot& snapshot
+  , const std::vector<std::pair<size_t, size_t>>& runs
+  )
+{
+  const int fd = open(path.c_str(), O_RDWR);
+
+  if(fd == -1) return AppStatus::FailureCharacterSave;
+
+  auto status = AppStatus::Success;
+
+  for(const auto& x : runs)
+  {
+    size_t first = x.first;
+    size_t count = x.second;
+
+    // Runs are written straight out of the snapshot, one bank at a time
+    while(count > 0 && status == AppStatus::Success)
+    {
+      const auto tiles    = snapshot.GetTiles(first, count);
+      const auto position = offset + first * Codec::TILE_BYTES;
+
+      if(pwrite(fd, tiles.data(), tiles.size(), position) != (ssize_t)tiles.size())
+      {
+        status = AppStatus::FailureCharacterSave;
+      }
+
+      first += tiles.size() / Codec::TILE_BYTES;
+      count -= tiles.size() / Codec::TILE_BYTES;
+    }
+  }
+
+  // Blank banks shown past the end of a short file are stored as well
+  struct stat info;
+
+  if( status == AppStatus::Success
+   && fstat(fd, &info) == 0
+   && (size_t)info.st_size < minimumSize
+   && ftruncate(fd, minimumSize) != 0
+    )
+  {
+    status = AppStatus::FailureCharacterSave;
+  }
+
+  // The journal drops its records for these tiles once this returns
+  if(status == AppStatus::Success && !Sync(fd)) status = AppStatus::FailureCharacterSave;
+
+  close(fd);
+
+  return status;
+}
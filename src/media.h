@@ -11,20 +11,49 @@
 #include <utility>
 #include <vector>
 #include <map>
+#include <memory>
+#include <iterator>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "appstatus.h"
 #include "debug.h"
+#include "codec.h"
+#include "rom.h"
+#include "worker.h"
+#include "bankstore.h"
 #include "character.h"
 
 class Character;
 
+struct CharacterFile
+{
+  AppStatus                      status;
+  std::shared_ptr<const GLubyte> chr;
+  size_t                         offset;
+  size_t                         size;
+};
+
+struct Image
+{
+  GLuint               width;
+  GLuint               height;
+  std::vector<GLubyte> rgba;
+};
+
 class Media
 {
 public:
   static AppStatus Start();
   static AppStatus Stop();
 
-  static std::pair<AppStatus, GLuint> LoadTexture(std::string path);
+  static std::pair<AppStatus, Image> LoadImage(std::string path);
+
+  // Allocates a single level R8UI image for the bound GL_TEXTURE_2D
+  static void AllocateByteTexture(GLsizei width, GLsizei height);
   
   static std::pair<AppStatus, GLuint> LoadShaderProgram(std::vector<std::string> filenames);
   
@@ -36,11 +65,43 @@ public:
   static AppStatus SaveCharacter();
   static AppStatus LoadCharacter();
 
+  static void SetCharacterPath(std::string path);
+
 private:
-  static std::pair<AppStatus, GLuint> LoadShader(std::string filename);
+  static std::pair<AppStatus, std::string> ReadShaderSource(std::string filename);
+  static std::pair<AppStatus, GLuint>      LoadShader(std::string filename, std::string source);
+
+  static uint64_t HashShaderSources
+    ( const std::vector<std::string>& filenames
+    , const std::vector<std::string>& sources
+    );
+
+  static GLuint LoadProgramBinary(std::string path);
+  static void   SaveProgramBinary(std::string path, GLuint programId);
+
+  static AppStatus SaveCharacterTiles();
+
+  // These run on the worker thread
+  static CharacterFile MapCharacter(std::string path);
+  static AppStatus     WriteFile(std::string path, const BankSnapshot& snapshot);
+  static AppStatus     WriteTiles
+    ( std::string path
+    , size_t offset
+    , size_t minimumSize
+    , const BankSnapshot& snapshot
+    , const std::vector<std::pair<size_t, size_t>>& runs
+    );
 
   /* static std::vector<GLuint>           shaders; */
   static std::map<std::string, GLuint> shaderPrograms;
+
+  static const std::string shaderCacheDirectory;
+
+  static std::string characterPath;
+  static size_t      characterOffset;
+  static size_t      characterSize;
+  static bool        characterBacked;
+  static bool        characterPending;
 };
 
 #endif
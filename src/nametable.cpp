@@ -2,133 +2,175 @@
 
 const glm::vec2 frustumSize = App::GetFrustumSize();
 
-const glm::vec2 Nametable::size = glm::vec2(frustumSize.x * 2, frustumSize.x * 2);
+// As wide as before, as tall as the 256 x 240 screen allows
+const glm::vec2 Nametable::size    = glm::vec2(frustumSize.x * 2, frustumSize.x * 2 * 240.0f / 256.0f);
 const GLfloat   Nametable::maxZoom = 24.0f;
 
+const glm::mat4 surface = glm::scale
+  ( glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f))
+  , glm::vec3(Nametable::GetSize(), 1.0f)
+  );
+
 glm::vec3 Nametable::position;
 
 GLfloat Nametable::zoom = 0;
 
 GLuint Nametable::programId;
-GLuint Nametable::vertexBufferId;
-GLuint Nametable::indexBufferId;
-GLuint Nametable::paletteTextureId;
-GLint  Nametable::mvpUniformId;
-GLint  Nametable::mouseUniformId;
-GLint  Nametable::tilesUniformId;
-
-std::vector<GLfloat>     Nametable::vertices;
-std::vector<GLuint>      Nametable::indices;
+GLuint Nametable::tilesTextureId;
+GLuint Nametable::attributesTextureId;
+
+GLint Nametable::mvpUniformId;
+GLint Nametable::mouseCellUniformId;
+GLint Nametable::mouseSpanUniformId;
+GLint Nametable::patternTableUniformId;
+GLint Nametable::characterTextureUniformId;
+GLint Nametable::tilesTextureUniformId;
+GLint Nametable::attributesTextureUniformId;
+
 std::vector<std::string> Nametable::filenames;
-std::vector<GLuint>      Nametable::tiles;
+
+std::array<GLubyte, Nametable::TILES_BYTES>      Nametable::tiles;
+std::array<GLubyte, Nametable::ATTRIBUTES_BYTES> Nametable::attributes;
+size_t                                           Nametable::patternTable = 0;
+
+static_assert(Nametable::SCREEN_BYTES == MapStore::CHUNK_BYTES, "A map chunk holds one screen");
+
+// Used when there is no map yet
+const glm::ivec2 Nametable::defaultScreens = glm::ivec2(64, 4);
+
+MapStore   Nametable::map;
+bool       Nametable::mapOpened = false;
+glm::ivec2 Nametable::screen = glm::ivec2(0);
 
 glm::mat4 Nametable::model;
 
-AppStatus Nametable::Start(GLuint textureId)
-{
-  vertices = 
-    { -size.x / 2, size.y / 2, -1.0f
-    , 0.0f, 1.0f
-    , size.x / 2, size.y / 2, -1.0f
-    , 1.0, 1.0f
-    , size.x / 2, -size.y / 2, -1.0f
-    , 1.0f, 0.0f
-    , -size.x / 2, -size.y / 2, -1.0f
-    , 0.0f, 0.0f
-    };
+std::shared_ptr<NametableDrawable> Nametable::drawable;
 
-  indices   = { 0, 1, 2, 2, 3, 0 };
+AppStatus Nametable::Start()
+{
   filenames = { "nametable.vert", "nametable.frag" };
 
-  for(int y = 0; y < 16; y++)
-  {
-    for(int x = 0; x < 16; x++)
-    {
-      tiles.push_back(y * x);
-    }
-  }
-
-  glGenBuffers(1, &vertexBufferId);
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-  
-  glGenBuffers(1, &indexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+  tiles.fill(0);
+  attributes.fill(0);
 
   const auto programResult = Media::LoadShaderProgram(filenames);
   if(programResult.first != AppStatus::Success) return programResult.first;
     
   programId = programResult.second;
 
-  paletteTextureId = textureId;
-  mvpUniformId     = glGetUniformLocation(programId, "mvp");
-  mouseUniformId   = glGetUniformLocation(programId, "mouse");
-  tilesUniformId   = glGetUniformLocation(programId, "tiles");
+  mvpUniformId               = glGetUniformLocation(programId, "mvp");
+  mouseCellUniformId         = glGetUniformLocation(programId, "mouseCell");
+  mouseSpanUniformId         = glGetUniformLocation(programId, "mouseSpan");
+  patternTableUniformId      = glGetUniformLocation(programId, "patternTable");
+  characterTextureUniformId  = glGetUniformLocation(programId, "characterTexture");
+  tilesTextureUniformId      = glGetUniformLocation(programId, "tilesTexture");
+  attributesTextureUniformId = glGetUniformLocation(programId, "attributesTexture");
+
+  Samples::BindUniformBlock(programId);
+
+  GLuint textureIds[2];
+
+  glGenTextures(2, textureIds);
+
+  tilesTextureId      = textureIds[0];
+  attributesTextureId = textureIds[1];
+
+  // Integer textures are fetched, never filtered
+  for(const auto x : textureIds)
+  {
+    glBindTexture(GL_TEXTURE_2D, x);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, tilesTextureId);
+  Media::AllocateByteTexture(CELLS_WIDE, CELLS_HIGH);
+
+  glBindTexture(GL_TEXTURE_2D, attributesTextureId);
+  Media::AllocateByteTexture(ATTRIBUTES_WIDE, ATTRIBUTES_WIDE);
+
+  // The map file is only opened once the nametable is shown or edited
+  mapOpened = false;
+
+  UploadTiles();
+  UploadAttributes();
 
   zoom     = 1.0f;
   position = glm::vec3(0.0f, 0.0f, -3.0f);
   model    = glm::translate(glm::mat4(1.0f), position);
 
+  drawable = std::make_shared<NametableDrawable>();
+
   return AppStatus::Success;
 }
 
 AppStatus Nametable::Stop()
 {
-  // GLuint textureIds[] = {};
-  GLuint bufferIds[]  = { vertexBufferId, indexBufferId };
+  const GLuint textureIds[] = { tilesTextureId, attributesTextureId };
 
-  // glDeleteTextures(1, textureIds);
-  glDeleteBuffers(2, bufferIds);
-  glDeleteProgram(programId);
+  glDeleteTextures(2, textureIds);
+
+  map.Close();
 
   return AppStatus::Success;
 }
 
 AppStatus Nametable::Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse)
 {    
+  OpenDefaultMap();
+
   model = glm::translate(glm::mat4(1.0f), glm::vec3(position.x * zoom, position.y * zoom, position.z));
     
-  const auto mvp          = projection * view * glm::scale(model, glm::vec3(zoom));
-  // const auto samples      = Samples::GetSamples();
-  // const auto activeSample = Samples::GetActiveSample();
-  // const auto activeColor  = Samples::GetActiveColor();
+  const auto mvp = projection * view * glm::scale(model, glm::vec3(zoom)) * surface;
+
+  // Attributes are edited a 2 x 2 block of cells at a time
+  const auto span      = App::GetMode() == AppMode::AttributeTableMode ? 2 : 1;
+  const auto mouseCell = mouse.x >= 0.0f ? SurfaceToCell(mouse) : glm::ivec2(-span);
+
+  Character::BindTexture();
 
-  mouse.y = 1.0f - mouse.y;
-  
   glUseProgram(programId);
 
   glUniformMatrix4fv(mvpUniformId, 1, GL_FALSE, &mvp[0][0]);
-  glUniform2fv(mouseUniformId, 1, &mouse[0]);
-  glUniform1uiv(tilesUniformId, tiles.size(), tiles.data());
-  // glUniform1ui(activeSampleUniformId, activeSample);
-  // glUniform1ui(activeColorUniformId, activeColor);
-  // glUniform1i(paletteTextureUniformId, 0);
-  // glUniform1i(characterTextureUniformId, 1);
-
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, paletteTextureId);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexPositionOffset);
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexUvOffset);
-  
-  glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (void*)0);
-  
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
+  glUniform2i(mouseCellUniformId, mouseCell.x, mouseCell.y);
+  glUniform1i(mouseSpanUniformId, span);
+  glUniform1ui(patternTableUniformId, patternTable);
+  glUniform1i(characterTextureUniformId, 1);
+  glUniform1i(tilesTextureUniformId, 3);
+  glUniform1i(attributesTextureUniformId, 4);
+
+  glActiveTexture(GL_TEXTURE3);
+  glBindTexture(GL_TEXTURE_2D, tilesTextureId);
+
+  glActiveTexture(GL_TEXTURE4);
+  glBindTexture(GL_TEXTURE_2D, attributesTextureId);
+
+  Quad::Draw();
 
   return AppStatus::Success;
 }
 
 bool Nametable::Click(glm::vec2 mouse)
 {
-  return false;
+  const auto cell = SurfaceToCell(mouse);
+
+  if(App::GetMode() == AppMode::AttributeTableMode)
+  {
+    // The first four samples are the background sub-palettes
+    SetSubPalette(cell, Samples::GetActiveSample() % 4);
+  }
+  else
+  {
+    // Tile indices only reach into the pattern table that is shown
+    GLubyte tile;
+
+    if(!Character::GetActiveTile(patternTable, &tile)) return false;
+
+    SetCell(cell, tile);
+  }
+
+  return true;
 }
 
 void Nametable::Zoom(GLfloat x)
@@ -154,3 +196,200 @@ GLfloat Nametable::GetZoom()
 {
   return zoom;
 }
+
+std::shared_ptr<IDrawable> Nametable::GetDrawable()
+{
+  return drawable;
+}
+
+GLubyte Nametable::GetCell(glm::ivec2 cell)
+{
+  return tiles[cell.y * CELLS_WIDE + cell.x];
+}
+
+void Nametable::SetCell(glm::ivec2 cell, GLubyte tile)
+{
+  OpenDefaultMap();
+
+  auto& x = tiles[cell.y * CELLS_WIDE + cell.x];
+
+  if(x == tile) return;
+
+  x = tile;
+
+  const auto chunk = map.GetWritableChunk(screen);
+  if(chunk != nullptr) chunk[cell.y * CELLS_WIDE + cell.x] = tile;
+
+  glActiveTexture(GL_TEXTURE3);
+  glBindTexture(GL_TEXTURE_2D, tilesTextureId);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, cell.x, cell.y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &x);
+
+  App::Invalidate();
+}
+
+GLubyte Nametable::GetSubPalette(glm::ivec2 cell)
+{
+  const auto shift = ((cell.y / 2) % 2) * 4 + ((cell.x / 2) % 2) * 2;
+
+  return (attributes[(cell.y / 4) * ATTRIBUTES_WIDE + cell.x / 4] >> shift) & 3;
+}
+
+void Nametable::SetSubPalette(glm::ivec2 cell, GLubyte subPalette)
+{
+  OpenDefaultMap();
+
+  // Top left, top right, bottom left and bottom right quarters from the lowest bits up
+  const auto shift = ((cell.y / 2) % 2) * 4 + ((cell.x / 2) % 2) * 2;
+  const auto block = glm::ivec2(cell.x / 4, cell.y / 4);
+
+  auto& x = attributes[block.y * ATTRIBUTES_WIDE + block.x];
+
+  const GLubyte attribute = (x & ~(3 << shift)) | ((subPalette & 3) << shift);
+
+  if(x == attribute) return;
+
+  x = attribute;
+
+  const auto chunk = map.GetWritableChunk(screen);
+  if(chunk != nullptr) chunk[TILES_BYTES + block.y * ATTRIBUTES_WIDE + block.x] = attribute;
+
+  glActiveTexture(GL_TEXTURE4);
+  glBindTexture(GL_TEXTURE_2D, attributesTextureId);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, block.x, block.y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &x);
+
+  App::Invalidate();
+}
+
+void Nametable::GetScreen(GLubyte* data)
+{
+  std::copy(tiles.begin(), tiles.end(), data);
+  std::copy(attributes.begin(), attributes.end(), data + TILES_BYTES);
+}
+
+void Nametable::SetScreen(const GLubyte* data)
+{
+  OpenDefaultMap();
+
+  std::copy(data, data + TILES_BYTES, tiles.begin());
+  std::copy(data + TILES_BYTES, data + SCREEN_BYTES, attributes.begin());
+
+  const auto chunk = map.GetWritableChunk(screen);
+  if(chunk != nullptr) std::copy(data, data + SCREEN_BYTES, chunk);
+
+  UploadTiles();
+  UploadAttributes();
+
+  App::Invalidate();
+}
+
+size_t Nametable::GetPatternTable()
+{
+  return patternTable;
+}
+
+void Nametable::SetPatternTable(size_t side)
+{
+  patternTable = side % 2;
+
+  App::Invalidate();
+}
+
+AppStatus Nametable::OpenMap(std::string path, glm::ivec2 screens)
+{
+  mapOpened = true;
+
+  const auto result = map.Open(path, screens);
+
+  screen = glm::ivec2(0);
+
+  if(result == AppStatus::Success) ShowScreen();
+
+  return result;
+}
+
+void Nametable::Scroll(glm::ivec2 screens)
+{
+  OpenDefaultMap();
+
+  const auto last      = glm::max(map.GetScreens() - 1, glm::ivec2(0));
+  const auto newScreen = glm::clamp(screen + screens, glm::ivec2(0), last);
+
+  if(newScreen == screen) return;
+
+  screen = newScreen;
+
+  ShowScreen();
+}
+
+glm::ivec2 Nametable::GetMapScreen()
+{
+  return screen;
+}
+
+Mirroring Nametable::GetMirroring()
+{
+  // Cycling the mirroring starts from the one stored in the map
+  OpenDefaultMap();
+
+  return map.GetMirroring();
+}
+
+void Nametable::SetMirroring(Mirroring mirroring)
+{
+  OpenDefaultMap();
+
+  map.SetMirroring(mirroring);
+
+  // The same position may now show another screen's data
+  ShowScreen();
+}
+
+void Nametable::ShowScreen()
+{
+  const auto chunk = map.GetChunk(screen);
+  if(chunk == nullptr) return;
+
+  std::copy(chunk, chunk + TILES_BYTES, tiles.begin());
+  std::copy(chunk + TILES_BYTES, chunk + SCREEN_BYTES, attributes.begin());
+
+  UploadTiles();
+  UploadAttributes();
+
+  App::Invalidate();
+}
+
+void Nametable::OpenDefaultMap()
+{
+  if(mapOpened) return;
+
+  // Without its map the nametable still edits the one screen in memory
+  const auto result = OpenMap("nametable.map", defaultScreens);
+  if(result != AppStatus::Success) Debug::LogStatus(result);
+}
+
+glm::ivec2 Nametable::SurfaceToCell(glm::vec2 surface)
+{
+  const auto cells = glm::vec2(CELLS_WIDE, CELLS_HIGH);
+
+  return glm::clamp(glm::ivec2(glm::floor(surface * cells)), glm::ivec2(0), glm::ivec2(cells) - 1);
+}
+
+void Nametable::UploadTiles()
+{
+  glActiveTexture(GL_TEXTURE3);
+  glBindTexture(GL_TEXTURE_2D, tilesTextureId);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, CELLS_WIDE, CELLS_HIGH, GL_RED_INTEGER, GL_UNSIGNED_BYTE, tiles.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void Nametable::UploadAttributes()
+{
+  glActiveTexture(GL_TEXTURE4);
+  glBindTexture(GL_TEXTURE_2D, attributesTextureId);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, ATTRIBUTES_WIDE, ATTRIBUTES_WIDE, GL_RED_INTEGER, GL_UNSIGNED_BYTE, attributes.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
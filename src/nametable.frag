@@ -4,22 +4,46 @@ in vec2 uv;
 
 out vec3 color;
 
-const uint TILES_SIZE   = 256u;
-const uint PALETTE_SIZE = 64u;
+const ivec2 SCREEN_SIZE = ivec2(256, 240);
 
-uniform sampler2D paletteTexture;
-uniform vec2      mouse;
-uniform uint      tiles[TILES_SIZE];
-
-vec3 tColor = texture(paletteTexture, vec2(1.0)).xyz;
+layout(std140) uniform SampleColors
+{
+    vec4 sampleColors[8 * 4];
+};
 
-uint y = uint(uv.y * sqrt(TILES_SIZE));
-uint x = uint(uv.x * sqrt(TILES_SIZE));
-uint i = uint(y * sqrt(TILES_SIZE) + x);
-vec3 c = vec3(tiles[i] / float(TILES_SIZE));
+uniform ivec2      mouseCell;
+uniform int        mouseSpan;         // Cells highlighted around the mouse, 2 for attributes
+uniform uint       patternTable;      // Visible bank the tile indices point into
+uniform usampler2D characterTexture;
+uniform usampler2D tilesTexture;      // One tile index per cell
+uniform usampler2D attributesTexture; // Attribute bytes as the PPU keeps them
 
 void main()
 {
-    color = tColor;
-    color = c;
+    ivec2 pixel = min(ivec2(uv.x * SCREEN_SIZE.x, (1.0 - uv.y) * SCREEN_SIZE.y), SCREEN_SIZE - 1);
+    ivec2 cell  = pixel / 8;
+
+    uint tile      = texelFetch(tilesTexture, cell, 0).r;
+    uint attribute = texelFetch(attributesTexture, cell / 4, 0).r;
+
+    // Two bits for each 2 x 2 quarter of the 4 x 4 cells a byte covers
+    uint shift      = uint(((cell.y / 2) % 2) * 4 + ((cell.x / 2) % 2) * 2);
+    uint subPalette = (attribute >> shift) & 3u;
+
+    int  index = int(patternTable * 256u + tile);
+    uint row   = uint(pixel.y % 8);
+    uint bit   = 7u - uint(pixel.x % 8);
+
+    uint low  = texelFetch(characterTexture, ivec2(row, index), 0).r;
+    uint high = texelFetch(characterTexture, ivec2(row + 8u, index), 0).r;
+
+    uint entry = ((low >> bit) & 1u) | (((high >> bit) & 1u) << 1u);
+
+    // Entry 0 of every sub-palette shows the one backdrop color
+    color = sampleColors[entry == 0u ? 0u : subPalette * 4u + entry].rgb;
+
+    if(cell / mouseSpan == mouseCell / mouseSpan)
+    {
+        color += vec3(0.1, 0.1, 0.0);
+    }
 }
@@ -7,18 +7,43 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
 #include <memory>
+#include <array>
 
 #include "appstatus.h"
 #include "media.h"
 #include "offset.h"
+#include "idrawable.h"
+#include "quad.h"
+#include "mapstore.h"
 #include "app.h"
 
 class App;
 
+struct NametableDrawable;
+
+/*
+  One screen of background as the PPU keeps it: 32 x 30 tile indices
+  followed by the 64 byte attribute table, two bits of sub-palette for
+  every 2 x 2 cells.
+
+  Tile indices and attribute bytes live in integer textures and the shader
+  decodes the tiles straight from the character texture, so an edit is a
+  single texel upload.
+
+  The screen is a view into a map of many screens. Edits go through to the
+  map, and moving to another screen pages in that one chunk.
+*/
 class Nametable
 {
 public:
-  static AppStatus Start(GLuint textureId);
+  static constexpr size_t CELLS_WIDE       = 32;
+  static constexpr size_t CELLS_HIGH       = 30;
+  static constexpr size_t TILES_BYTES      = CELLS_WIDE * CELLS_HIGH;
+  static constexpr size_t ATTRIBUTES_WIDE  = 8;
+  static constexpr size_t ATTRIBUTES_BYTES = ATTRIBUTES_WIDE * ATTRIBUTES_WIDE;
+  static constexpr size_t SCREEN_BYTES     = TILES_BYTES + ATTRIBUTES_BYTES;
+
+  static AppStatus Start();
   static AppStatus Stop();
   static AppStatus Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse);
 
@@ -29,7 +54,34 @@ public:
   static glm::vec2 GetPosition();
   static GLfloat   GetZoom();
 
+  static std::shared_ptr<IDrawable> GetDrawable();
+
+  static GLubyte GetCell(glm::ivec2 cell);
+  static void    SetCell(glm::ivec2 cell, GLubyte tile);
+  static GLubyte GetSubPalette(glm::ivec2 cell);
+  static void    SetSubPalette(glm::ivec2 cell, GLubyte subPalette);
+
+  // Whole screens in PPU layout, SCREEN_BYTES long
+  static void GetScreen(GLubyte* data);
+  static void SetScreen(const GLubyte* data);
+
+  static size_t GetPatternTable();
+  static void   SetPatternTable(size_t side);
+
+  static AppStatus OpenMap(std::string path, glm::ivec2 screens);
+  static void      Scroll(glm::ivec2 screens);
+
+  static glm::ivec2 GetMapScreen();
+  static Mirroring  GetMirroring();
+  static void       SetMirroring(Mirroring mirroring);
+
 private:
+  static glm::ivec2 SurfaceToCell(glm::vec2 surface);
+  static void       UploadTiles();
+  static void       UploadAttributes();
+  static void       ShowScreen();
+  static void       OpenDefaultMap();
+
   static const glm::vec2 size;
   static const GLfloat   maxZoom;
 
@@ -37,19 +89,62 @@ private:
   static GLfloat   zoom;
 
   static GLuint programId;
-  static GLuint vertexBufferId;
-  static GLuint indexBufferId;
-  static GLuint paletteTextureId;
-  static GLint  mvpUniformId;
-  static GLint  mouseUniformId;
-  static GLint  tilesUniformId;
-
-  static std::vector<GLfloat>     vertices;
-  static std::vector<GLuint>      indices;
+  static GLuint tilesTextureId;
+  static GLuint attributesTextureId;
+
+  static GLint mvpUniformId;
+  static GLint mouseCellUniformId;
+  static GLint mouseSpanUniformId;
+  static GLint patternTableUniformId;
+  static GLint characterTextureUniformId;
+  static GLint tilesTextureUniformId;
+  static GLint attributesTextureUniformId;
+
   static std::vector<std::string> filenames;
-  static std::vector<GLuint>      tiles;
+
+  static std::array<GLubyte, TILES_BYTES>      tiles;
+  static std::array<GLubyte, ATTRIBUTES_BYTES> attributes;
+  static size_t                                patternTable;
+
+  static const glm::ivec2 defaultScreens;
+
+  static MapStore   map;
+  static bool       mapOpened;
+  static glm::ivec2 screen;
 
   static glm::mat4 model;
+
+  static std::shared_ptr<NametableDrawable> drawable;
+};
+
+struct NametableDrawable : public IDrawable
+{
+  NametableDrawable() : IDrawable() {}
+
+  AppStatus Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse) override
+  {
+    return Nametable::Draw(projection, view, mouse);
+  }
+
+  glm::vec2 GetPosition() override
+  {
+    return Nametable::GetPosition();
+  }
+
+  glm::vec2 GetSize() override
+  {
+    return Nametable::GetSize();
+  }
+
+  GLfloat GetZoom() override
+  {
+    return Nametable::GetZoom();
+  }
+
+  bool Click(glm::vec2 mouse) override
+  {
+    return Nametable::Click(mouse);
+  }
 };
 
 #endif
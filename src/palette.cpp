@@ -10,15 +10,16 @@ glm::vec3 Palette::position = glm::vec3
   , -1.0f
   );
 
+const glm::mat4 surface = glm::scale
+  ( glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 1.0f))
+  , glm::vec3(Palette::GetSize(), 1.0f)
+  );
+
 GLuint Palette::programId;
-GLuint Palette::vertexBufferId;
-GLuint Palette::indexBufferId;
 GLuint Palette::paletteTextureId;
 GLint  Palette::mvpUniformId;
 GLint  Palette::mouseUniformId;
 
-std::vector<GLfloat>     Palette::vertices;
-std::vector<GLuint>      Palette::indices;
 std::vector<std::string> Palette::filenames;
 
 glm::mat4 Palette::model;
@@ -27,29 +28,8 @@ std::shared_ptr<PaletteDrawable> Palette::drawable;
 
 AppStatus Palette::Start()
 {
-  vertices =
-    { -size.x / 2, size.y / 2, 1.0f
-    , 0.0f, 1.0f
-    , size.x / 2, size.y / 2, 1.0f
-    , 1.0, 1.0f
-    , size.x / 2, -size.y / 2, 1.0f
-    , 1.0f, 0.0f
-    , -size.x / 2, -size.y / 2, 1.0f
-    , 0.0f, 0.0f
-    };
-
-  indices = { 0, 1, 2, 2, 3, 0 };
-
   filenames = { "palette.vert", "palette.frag" };
 
-  glGenBuffers(1, &vertexBufferId);
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-  
-  glGenBuffers(1, &indexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
-
   const auto programResult = Media::LoadShaderProgram(filenames);
   if(programResult.first != AppStatus::Success) return programResult.first;
   
@@ -85,18 +65,15 @@ AppStatus Palette::Start()
 AppStatus Palette::Stop()
 {
   GLuint textureIds[] = { paletteTextureId };
-  GLuint bufferIds[]  = { vertexBufferId, indexBufferId };
   
   glDeleteTextures(1, textureIds);
-  glDeleteBuffers(2, bufferIds);
-  glDeleteProgram(programId);
 
   return AppStatus::Success;
 }
 
 AppStatus Palette::Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse)
 {
-  const auto mvp = projection * view * model;
+  const auto mvp = projection * view * model * surface;
   
   mouse.y = 1.0f - mouse.y;
   
@@ -108,22 +85,7 @@ AppStatus Palette::Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse)
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, paletteTextureId);
   
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexPositionOffset);
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexUvOffset);
-  
-  glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (void*)0);
-  
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  Quad::Draw();
 
   return AppStatus::Success;
 }
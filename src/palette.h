@@ -13,6 +13,7 @@
 #include "media.h"
 #include "samples.h"
 #include "idrawable.h"
+#include "quad.h"
 
 class Samples;
 struct PaletteDrawable;
@@ -42,15 +43,11 @@ private:
   static glm::vec3 position;
   
   static GLuint programId;
-  static GLuint vertexBufferId;
-  static GLuint indexBufferId;
   static GLuint paletteTextureId;
   
   static GLint mvpUniformId;
   static GLint mouseUniformId;
   
-  static std::vector<GLfloat>     vertices;
-  static std::vector<GLuint>      indices;
   static std::vector<std::string> filenames;
   static std::vector<GLfloat>     pixels;
 
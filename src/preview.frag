@@ -0,0 +1,93 @@
+#version 330 core
+
+in vec2 uv;
+
+out vec3 color;
+
+const uvec2 TEXTURE_SIZE = uvec2(256, 128);
+
+layout(std140) uniform SampleColors
+{
+    vec4 sampleColors[8 * 4];
+};
+
+uniform uint       activeSample;
+uniform uint       activeEntry;
+uniform bool       plotting;
+uniform ivec2      mousePixel;
+uniform ivec2      maskOrigin;
+uniform ivec2      maskSize;
+uniform usampler2D characterTexture;
+uniform usampler2D maskTexture; // Pixels of the plotted shape, rasterized on the CPU
+uniform ivec2      selectionOrigin;
+uniform ivec2      selectionSize;
+uniform ivec2      selectionOffset; // How far the selection is being dragged
+uniform bool       selectionMoving;
+
+// Cells count from the bottom left of the canvas, pixels from the top left like the tiles
+
+vec3 Tone(ivec2 at)
+{
+    uvec2 pixel = uvec2(at);
+
+    uint side = pixel.x / 128u;
+    uint tile = side * 256u + (pixel.y / 8u) * 16u + (pixel.x % 128u) / 8u;
+    uint row  = pixel.y % 8u;
+    uint bit  = 7u - pixel.x % 8u;
+
+    uint low  = texelFetch(characterTexture, ivec2(row, tile), 0).r;
+    uint high = texelFetch(characterTexture, ivec2(row + 8u, tile), 0).r;
+
+    uint attributeValue = ((low >> bit) & 1u) | (((high >> bit) & 1u) << 1u);
+
+    return sampleColors[activeSample * 4u + attributeValue].rgb;
+}
+
+bool OnPlot(ivec2 pixel)
+{
+    ivec2 offset = pixel - maskOrigin;
+
+    if(any(lessThan(offset, ivec2(0))) || any(greaterThanEqual(offset, maskSize))) return false;
+
+    return texelFetch(maskTexture, offset, 0).r != 0u;
+}
+
+bool Inside(ivec2 pixel, ivec2 origin, ivec2 size)
+{
+    return all(greaterThanEqual(pixel, origin)) && all(lessThan(pixel, origin + size));
+}
+
+void main()
+{
+    ivec2 cell  = min(ivec2(uv * vec2(TEXTURE_SIZE)), ivec2(TEXTURE_SIZE) - 1);
+    ivec2 pixel = ivec2(cell.x, int(TEXTURE_SIZE.y) - 1 - cell.y);
+
+    vec3 activeTone = sampleColors[activeSample * 4u + activeEntry].rgb;
+
+    ivec2 destination = selectionOrigin + selectionOffset;
+
+    if(plotting && OnPlot(pixel) || pixel == mousePixel)
+    {
+        color = activeTone;
+    }
+    else if(selectionSize.x > 0 && Inside(pixel, destination - 1, selectionSize + 2) && !Inside(pixel, destination, selectionSize))
+    {
+        color = vec3(1.0) - Tone(pixel);
+    }
+    else if(selectionMoving && Inside(pixel, destination, selectionSize))
+    {
+        color = Tone(pixel - selectionOffset);
+    }
+    else if(selectionMoving && Inside(pixel, selectionOrigin, selectionSize))
+    {
+        color = sampleColors[activeSample * 4u].rgb;
+    }
+    else if((pixel.x == mousePixel.x || pixel.y == mousePixel.y) && (cell.x + cell.y) % 2 == 0)
+    {
+        color = Tone(pixel) + vec3(0.1, 0.1, 0.0);
+    }
+    else
+    {
+        discard;
+    }
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+layout(location = 0) in vec3 positionModel;
+layout(location = 1) in vec2 inUv;
+
+out vec2 uv;
+
+uniform mat4 mvp;
+uniform vec4 area; // Corner and size of the covered part of the canvas, in canvas uv
+
+void main()
+{
+    uv = area.xy + inUv * area.zw;
+
+    // The canvas quad spans -0.5 to 0.5 with uv from 0 to 1
+    gl_Position = mvp * vec4(uv - 0.5, positionModel.z, 1);
+}
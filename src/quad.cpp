@@ -0,0 +1,178 @@
+#include "quad.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "offset.h"
+
+GLuint Quad::meshVaoId;
+GLuint Quad::batchVaoId;
+GLuint Quad::vertexBufferId;
+GLuint Quad::indexBufferId;
+GLuint Quad::instanceBufferId;
+
+std::vector<Quad::Queued> Quad::queued;
+std::vector<QuadInstance> Quad::instances;
+
+AppStatus Quad::Start()
+{
+  // Unit square, the top left corner has uv (0, 1)
+  const GLfloat vertices[] =
+    { -0.5f, 0.5f, 0.0f
+    , 0.0f, 1.0f
+    , 0.5f, 0.5f, 0.0f
+    , 1.0f, 1.0f
+    , 0.5f, -0.5f, 0.0f
+    , 1.0f, 0.0f
+    , -0.5f, -0.5f, 0.0f
+    , 0.0f, 0.0f
+    };
+
+  const GLuint indices[] = { 0, 1, 2, 2, 3, 0 };
+
+  glGenBuffers(1, &vertexBufferId);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+  glGenBuffers(1, &indexBufferId);
+  glBindBuffer(GL_ARRAY_BUFFER, indexBufferId);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+  glGenBuffers(1, &instanceBufferId);
+
+  GLuint vaoIds[2];
+
+  glGenVertexArrays(2, vaoIds);
+
+  meshVaoId  = vaoIds[0];
+  batchVaoId = vaoIds[1];
+
+  // Both layouts are recorded once, drawing only binds them
+  for(const auto x : vaoIds)
+  {
+    glBindVertexArray(x);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexPositionOffset);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexUvOffset);
+  }
+
+  glBindVertexArray(batchVaoId);
+  glBindBuffer(GL_ARRAY_BUFFER, instanceBufferId);
+
+  for(GLuint i = 2; i <= 6; i++)
+  {
+    glEnableVertexAttribArray(i);
+    glVertexAttribDivisor(i, 1);
+  }
+
+  PointInstances(0);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glBindVertexArray(meshVaoId);
+
+  return AppStatus::Success;
+}
+
+AppStatus Quad::Stop()
+{
+  const GLuint vaoIds[]    = { meshVaoId, batchVaoId };
+  const GLuint bufferIds[] = { vertexBufferId, indexBufferId, instanceBufferId };
+
+  glDeleteVertexArrays(2, vaoIds);
+  glDeleteBuffers(3, bufferIds);
+
+  return AppStatus::Success;
+}
+
+void Quad::Draw()
+{
+  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
+}
+
+void Quad::Queue(GLuint programId, GLuint textureId, const QuadInstance& instance)
+{
+  queued.push_back({ programId, textureId, instance });
+}
+
+void Quad::Flush(glm::mat4 viewProjection)
+{
+  if(queued.empty()) return;
+
+  std::stable_sort
+    ( queued.begin()
+    , queued.end()
+    , [](const Queued& a, const Queued& b) -> bool
+      {
+        return a.programId != b.programId
+          ? a.programId < b.programId
+          : a.textureId < b.textureId;
+      }
+    );
+
+  instances.clear();
+
+  for(const auto& x : queued) instances.push_back(x.instance);
+
+  glBindVertexArray(batchVaoId);
+  glBindBuffer(GL_ARRAY_BUFFER, instanceBufferId);
+
+  // Orphaned every frame so the driver never waits on the previous one
+  glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(QuadInstance), instances.data(), GL_STREAM_DRAW);
+
+  GLuint program = 0;
+  size_t first   = 0;
+
+  while(first < queued.size())
+  {
+    auto last = first + 1;
+
+    while( last < queued.size()
+        && queued[last].programId == queued[first].programId
+        && queued[last].textureId == queued[first].textureId
+         )
+    {
+      last++;
+    }
+
+    if(queued[first].programId != program)
+    {
+      program = queued[first].programId;
+
+      glUseProgram(program);
+      glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, &viewProjection[0][0]);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, queued[first].textureId);
+
+    PointInstances(first);
+
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0, last - first);
+
+    first = last;
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(meshVaoId);
+
+  queued.clear();
+}
+
+void Quad::PointInstances(size_t first)
+{
+  const auto stride = sizeof(QuadInstance);
+  const auto base   = first * stride;
+
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(QuadInstance, rect)));
+  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(QuadInstance, uvRect)));
+  glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(QuadInstance, mouse)));
+  glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(QuadInstance, depth)));
+  glVertexAttribIPointer(6, 1, GL_UNSIGNED_INT, stride, (void*)(base + offsetof(QuadInstance, flags)));
+}
@@ -0,0 +1,57 @@
+#ifndef QUAD_H
+#define QUAD_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "appstatus.h"
+
+struct QuadInstance
+{
+  glm::vec4 rect;   // Center and size
+  glm::vec4 uvRect; // Corner and size of the texture area
+  glm::vec2 mouse;
+  GLfloat   depth;
+  GLuint    flags;
+};
+
+/*
+  The one quad mesh every surface is drawn with.
+
+  Surfaces with their own shader draw it directly, scaled to their size
+  with a model matrix. Small widgets that share a shader are queued as
+  instances instead and drawn together at the end of the frame, sorted by
+  program and texture.
+*/
+class Quad
+{
+public:
+  static AppStatus Start();
+  static AppStatus Stop();
+
+  static void Draw();
+  static void Queue(GLuint programId, GLuint textureId, const QuadInstance& instance);
+  static void Flush(glm::mat4 viewProjection);
+
+private:
+  struct Queued
+  {
+    GLuint       programId;
+    GLuint       textureId;
+    QuadInstance instance;
+  };
+
+  static void PointInstances(size_t first);
+
+  static GLuint meshVaoId;
+  static GLuint batchVaoId;
+  static GLuint vertexBufferId;
+  static GLuint indexBufferId;
+  static GLuint instanceBufferId;
+
+  static std::vector<Queued>       queued;
+  static std::vector<QuadInstance> instances;
+};
+
+#endif
@@ -0,0 +1,270 @@
+#include "raster.h"
+
+RasterMask Raster::Plot(Tool tool, glm::ivec2 start, glm::ivec2 end)
+{
+  RasterMask mask;
+
+  mask.origin = glm::min(start, end);
+  mask.size   = glm::max(start, end) - mask.origin + 1;
+
+  mask.cells.assign(mask.size.x * mask.size.y, 0);
+
+  switch(tool)
+  {
+  case Tool::Pixel:
+    Set(&mask, 0, 0);
+    break;
+
+  case Tool::Line:
+    Line(&mask, start - mask.origin, end - mask.origin);
+    break;
+
+  case Tool::RectangleFrame:
+  case Tool::RectangleFill:
+    Rectangle(&mask, tool == Tool::RectangleFill);
+    break;
+
+  case Tool::RectangleCheckerboard:
+    Checkerboard(&mask);
+    break;
+
+  case Tool::EllipseFrame:
+  case Tool::EllipseFill:
+    Ellipse(&mask, tool == Tool::EllipseFill);
+    break;
+
+  default:
+    break;
+  }
+
+  return mask;
+}
+
+RasterMask Raster::Fill(View<const GLubyte> colors, glm::ivec2 origin, glm::ivec2 size, glm::ivec2 start)
+{
+  RasterMask mask;
+
+  mask.origin = origin;
+  mask.size   = size;
+
+  mask.cells.assign(size.x * size.y, 0);
+
+  start = start - origin;
+
+  if(start.x < 0 || start.y < 0 || start.x >= size.x || start.y >= size.y) return mask;
+
+  const auto target = colors[start.y * size.x + start.x];
+
+  const auto open = [&](int x, int y) -> bool
+    {
+      const auto i = y * size.x + x;
+      return mask.cells[i] == 0 && colors[i] == target;
+    };
+
+  // Seeds are kept on an explicit stack, one per run of open pixels
+  std::vector<glm::ivec2> seeds;
+
+  seeds.reserve(size.y * 2);
+  seeds.push_back(start);
+
+  while(!seeds.empty())
+  {
+    const auto seed = seeds.back();
+    seeds.pop_back();
+
+    if(!open(seed.x, seed.y)) continue;
+
+    int first = seed.x;
+    int last  = seed.x;
+
+    while(first > 0 && open(first - 1, seed.y))        first--;
+    while(last < size.x - 1 && open(last + 1, seed.y)) last++;
+
+    Span(&mask, seed.y, first, last);
+
+    // The rows above and below get a seed at the start of every run they have under this span
+    for(const auto y : { seed.y - 1, seed.y + 1 })
+    {
+      if(y < 0 || y >= size.y) continue;
+
+      bool inRun = false;
+
+      for(int x = first; x <= last; x++)
+      {
+        const auto isOpen = open(x, y);
+
+        if(isOpen && !inRun) seeds.push_back(glm::ivec2(x, y));
+
+        inRun = isOpen;
+      }
+    }
+  }
+
+  return mask;
+}
+
+void Raster::Merge(RasterMask* mask, const RasterMask& other)
+{
+  const auto offset = other.origin - mask->origin;
+
+  for(int y = 0; y < other.size.y; y++)
+  {
+    for(int x = 0; x < other.size.x; x++)
+    {
+      if(other.Get(x, y)) Set(mask, offset.x + x, offset.y + y);
+    }
+  }
+}
+
+void Raster::Line(RasterMask* mask, glm::ivec2 a, glm::ivec2 b)
+{
+  // Bresenham, stepping along both axes as the error allows
+  const int dx = abs(b.x - a.x);
+  const int dy = -abs(b.y - a.y);
+  const int sx = a.x < b.x ? 1 : -1;
+  const int sy = a.y < b.y ? 1 : -1;
+
+  int error = dx + dy;
+
+  while(true)
+  {
+    Set(mask, a.x, a.y);
+
+    if(a == b) break;
+
+    const auto e2 = 2 * error;
+
+    if(e2 >= dy)
+    {
+      error += dy;
+      a.x   += sx;
+    }
+
+    if(e2 <= dx)
+    {
+      error += dx;
+      a.y   += sy;
+    }
+  }
+}
+
+void Raster::Rectangle(RasterMask* mask, bool fill)
+{
+  const auto last = mask->size - 1;
+
+  for(int y = 0; y <= last.y; y++)
+  {
+    if(fill || y == 0 || y == last.y)
+    {
+      Span(mask, y, 0, last.x);
+    }
+    else
+    {
+      Set(mask, 0, y);
+      Set(mask, last.x, y);
+    }
+  }
+}
+
+void Raster::Checkerboard(RasterMask* mask)
+{
+  // The pattern is anchored to the canvas, not to where the plot started
+  for(int y = 0; y < mask->size.y; y++)
+  {
+    for(int x = 0; x < mask->size.x; x++)
+    {
+      if((mask->origin.x + x + mask->origin.y + y) % 2 == 0) Set(mask, x, y);
+    }
+  }
+}
+
+void Raster::Ellipse(RasterMask* mask, bool fill)
+{
+  // A single row or column is a line the walk below would leave open
+  if(mask->size.x == 1 || mask->size.y == 1)
+  {
+    Rectangle(mask, true);
+    return;
+  }
+
+  // Midpoint ellipse inside the bounding box, any width and height.
+  // The four quadrants are walked together from the sides towards the middle
+  int64_t a  = mask->size.x - 1;
+  int64_t b  = mask->size.y - 1;
+  int64_t b1 = b & 1;
+
+  int64_t dx    = 4 * (1 - a) * b * b;
+  int64_t dy    = 4 * (b1 + 1) * a * a;
+  int64_t error = dx + dy + b1 * a * a;
+
+  int x0 = 0;
+  int x1 = a;
+  int y0 = (b + 1) / 2;
+  int y1 = y0 - b1;
+
+  a  = 8 * a * a;
+  b1 = 8 * b * b;
+
+  do
+  {
+    Set(mask, x1, y0);
+    Set(mask, x0, y0);
+    Set(mask, x0, y1);
+    Set(mask, x1, y1);
+
+    const auto e2 = 2 * error;
+
+    if(e2 <= dy)
+    {
+      y0++;
+      y1--;
+      error += dy += a;
+    }
+
+    if(e2 >= dx || 2 * error > dy)
+    {
+      x0++;
+      x1--;
+      error += dx += b1;
+    }
+  }
+  while(x0 <= x1);
+
+  // Very flat ellipses stop early, their tips are finished here
+  while(y0 - y1 <= b)
+  {
+    Set(mask, x0 - 1, y0);
+    Set(mask, x1 + 1, y0++);
+    Set(mask, x0 - 1, y1);
+    Set(mask, x1 + 1, y1--);
+  }
+
+  if(!fill) return;
+
+  // Every row is filled between the outermost pixels of the outline
+  for(int y = 0; y < mask->size.y; y++)
+  {
+    const auto row   = mask->cells.begin() + y * mask->size.x;
+    const auto first = std::find(row, row + mask->size.x, 1);
+
+    if(first == row + mask->size.x) continue;
+
+    const auto last = std::find(std::make_reverse_iterator(row + mask->size.x), std::make_reverse_iterator(row), 1);
+
+    Span(mask, y, first - row, mask->size.x - 1 - (last - std::make_reverse_iterator(row + mask->size.x)));
+  }
+}
+
+void Raster::Set(RasterMask* mask, int x, int y)
+{
+  if(x < 0 || y < 0 || x >= mask->size.x || y >= mask->size.y) return;
+
+  mask->cells[y * mask->size.x + x] = 1;
+}
+
+void Raster::Span(RasterMask* mask, int y, int first, int last)
+{
+  const auto row = mask->cells.begin() + y * mask->size.x;
+
+  std::fill(row + first, row + last + 1, 1);
+}
@@ -0,0 +1,51 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <iterator>
+
+#include "tool.h"
+#include "view.h"
+
+/*
+  Pixels covered by a plotted shape, over the shape's bounding box.
+
+  One byte per pixel, rows from the top like the character data. The same
+  mask is shown as the preview while plotting and written into the tiles
+  when the plot is released, so both always agree.
+*/
+struct RasterMask
+{
+  glm::ivec2           origin; // Top left pixel of the bounding box
+  glm::ivec2           size;
+  std::vector<GLubyte> cells;
+
+  bool Get(int x, int y) const
+  {
+    return cells[y * size.x + x] != 0;
+  }
+};
+
+class Raster
+{
+public:
+  static RasterMask Plot(Tool tool, glm::ivec2 start, glm::ivec2 end);
+  static RasterMask Fill(View<const GLubyte> colors, glm::ivec2 origin, glm::ivec2 size, glm::ivec2 start);
+
+  static void Merge(RasterMask* mask, const RasterMask& other);
+
+private:
+  static void Line(RasterMask* mask, glm::ivec2 a, glm::ivec2 b);
+  static void Rectangle(RasterMask* mask, bool fill);
+  static void Checkerboard(RasterMask* mask);
+  static void Ellipse(RasterMask* mask, bool fill);
+  static void Set(RasterMask* mask, int x, int y);
+  static void Span(RasterMask* mask, int y, int first, int last);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "rom.h"
+
+bool Rom::IsRom(const GLubyte* data, size_t length)
+{
+  return length >= HEADER_SIZE
+      && data[0] == 'N'
+      && data[1] == 'E'
+      && data[2] == 'S'
+      && data[3] == 0x1A;
+}
+
+std::pair<AppStatus, RomHeader> Rom::ParseHeader(const GLubyte* data, size_t length)
+{
+  RomHeader header = {};
+
+  if(!IsRom(data, length)) return std::make_pair(AppStatus::FailureRomHeader, header);
+
+  header.isNes2     = (data[7] & 0x0C) == 0x08;
+  header.hasTrainer = (data[6] & 0x04) != 0;
+  header.mapper     = (data[6] >> 4) | (data[7] & 0xF0);
+
+  // NES 2.0 adds the upper size nibbles in byte 9
+  const GLubyte prgMsb = header.isNes2 ? data[9] & 0x0F : 0;
+  const GLubyte chrMsb = header.isNes2 ? data[9] >> 4   : 0;
+
+  if(header.isNes2) header.mapper |= (data[8] & 0x0F) << 8;
+
+  const auto prg = DecodeSize(data[4], prgMsb, 16384);
+  const auto chr = DecodeSize(data[5], chrMsb, 8192);
+
+  if(!prg.first || !chr.first) return std::make_pair(AppStatus::FailureRomHeader, header);
+
+  header.prgSize   = prg.second;
+  header.chrSize   = chr.second;
+  header.chrOffset = HEADER_SIZE + (header.hasTrainer ? TRAINER_SIZE : 0) + header.prgSize;
+
+  if(header.chrOffset > length || header.chrSize > length - header.chrOffset)
+  {
+    return std::make_pair(AppStatus::FailureRomHeader, header);
+  }
+
+  return std::make_pair(AppStatus::Success, header);
+}
+
+std::pair<bool, size_t> Rom::DecodeSize(GLubyte lsb, GLubyte msb, size_t unit)
+{
+  if(msb != 0x0F) return std::make_pair(true, (size_t)((msb << 8) | lsb) * unit);
+
+  // Exponent-multiplier notation, 2^E * (MM * 2 + 1) bytes
+  const size_t exponent   = lsb >> 2;
+  const size_t multiplier = (lsb & 0x03) * 2 + 1;
+
+  if(exponent > 32) return std::make_pair(false, (size_t)0);
+
+  return std::make_pair(true, ((size_t)1 << exponent) * multiplier);
+}
@@ -0,0 +1,37 @@
+#ifndef ROM_H
+#define ROM_H
+
+#include <GL/glew.h>
+#include <utility>
+#include <cstddef>
+
+#include "appstatus.h"
+
+struct RomHeader
+{
+  bool   isNes2;
+  bool   hasTrainer;
+  GLuint mapper;
+  size_t prgSize;
+  size_t chrSize;
+  size_t chrOffset;
+};
+
+/*
+  Reads iNES and NES 2.0 headers so the CHR-ROM can be located in place.
+*/
+class Rom
+{
+public:
+  static const size_t HEADER_SIZE  = 16;
+  static const size_t TRAINER_SIZE = 512;
+
+  static bool IsRom(const GLubyte* data, size_t length);
+
+  static std::pair<AppStatus, RomHeader> ParseHeader(const GLubyte* data, size_t length);
+
+private:
+  static std::pair<bool, size_t> DecodeSize(GLubyte lsb, GLubyte msb, size_t unit);
+};
+
+#endif
@@ -13,23 +13,25 @@ glm::vec3 Samples::position = glm::vec3
   , 1.0f
   );
 
+const glm::mat4 surface = glm::scale
+  ( glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f))
+  , glm::vec3(Samples::GetSize(), 1.0f)
+  );
+
+const GLuint Samples::uniformBinding = 0;
+
 glm::mat4 Samples::model;
 
 GLuint Samples::activeSample;
 GLuint Samples::activeColor;
 
 GLuint Samples::programId;
-GLuint Samples::vertexBufferId;
-GLuint Samples::indexBufferId;
-GLuint Samples::paletteTextureId;
+GLuint Samples::uniformBufferId = 0;
 GLint  Samples::mvpUniformId;
-GLint  Samples::samplesUniformId;
 GLint  Samples::activeSampleUniformId;
 GLint  Samples::activeColorUniformId;
 GLint  Samples::mouseUniformId;
 
-std::vector<GLfloat>     Samples::vertices;
-std::vector<GLuint>      Samples::indices;
 std::vector<std::string> Samples::filenames;
 
 std::shared_ptr<std::vector<GLuint>> Samples::samples =
@@ -42,41 +44,30 @@ std::shared_ptr<std::vector<GLuint>> Samples::samples =
 
 std::shared_ptr<SamplesDrawable> Samples::drawable;
 
-AppStatus Samples::Start(GLuint textureId)
+AppStatus Samples::Start()
 {
-  vertices = 
-    { -size.x / 2, size.y / 2, -1.0f
-    , 0.0f, 1.0f
-    , size.x / 2, size.y / 2, -1.0f
-    , 1.0, 1.0f
-    , size.x / 2, -size.y / 2, -1.0f
-    , 1.0f, 0.0f
-    , -size.x / 2, -size.y / 2, -1.0f
-    , 0.0f, 0.0f
-    };
-
-  indices = { 0, 1, 2, 2, 3, 0 };
-
   filenames = { "samples.vert", "samples.frag" };
 
-  glGenBuffers(1, &vertexBufferId);
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-  
-  glGenBuffers(1, &indexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
     
   const auto programResult = Media::LoadShaderProgram(filenames);
   if(programResult.first != AppStatus::Success) return programResult.first;
   
-  programId        = programResult.second;
-  paletteTextureId = textureId;
-  model            = glm::translate(glm::mat4(1.0f), position);
+  programId = programResult.second;
+  model     = glm::translate(glm::mat4(1.0f), position);
+
+  // Eight sub-palettes of four std140 vec4 colors, shared by every program
+  glGenBuffers(1, &uniformBufferId);
+  glBindBuffer(GL_UNIFORM_BUFFER, uniformBufferId);
+  glBufferData(GL_UNIFORM_BUFFER, 8 * 4 * 4 * sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindBufferBase(GL_UNIFORM_BUFFER, uniformBinding, uniformBufferId);
+
+  UpdateUniformBuffer();
+  BindUniformBlock(programId);
   
   mvpUniformId          = glGetUniformLocation(programId, "mvp");
   mouseUniformId        = glGetUniformLocation(programId, "mouse");
-  samplesUniformId      = glGetUniformLocation(programId, "samples");
   activeSampleUniformId = glGetUniformLocation(programId, "activeSample");
   activeColorUniformId  = glGetUniformLocation(programId, "activeColor");
 
@@ -88,48 +79,28 @@ AppStatus Samples::Start(GLuint textureId)
 AppStatus Samples::Stop()
 {
   //GLuint textureIds[] = { paletteTextureId };
-  GLuint bufferIds[] = { vertexBufferId, indexBufferId };
+  GLuint bufferIds[] = { uniformBufferId };
   
   //glDeleteTextures(1, textureIds);
-  glDeleteBuffers(2, bufferIds);
-  glDeleteProgram(programId);
+  glDeleteBuffers(1, bufferIds);
 
   return AppStatus::Success;
 }
 
 AppStatus Samples::Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse)
 {
-  const auto mvp = projection * view * model;
+  const auto mvp = projection * view * model * surface;
 
   mouse.y = 1.0f - mouse.y;
   
   glUseProgram(programId);
 
   glUniformMatrix4fv(mvpUniformId, 1, GL_FALSE, &mvp[0][0]);
-  glUniform1uiv(samplesUniformId, samples->size(), samples->data());
   glUniform2fv(mouseUniformId, 1, &mouse[0]);
   glUniform1ui(activeSampleUniformId, activeSample);
   glUniform1ui(activeColorUniformId, activeColor);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, paletteTextureId);
-  
-  glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
-  
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexPositionOffset);
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (void*)vertexUvOffset);
-  
-  glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (void*)0);
-  
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
-  
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  Quad::Draw();
 
   return AppStatus::Success;
 }
@@ -171,7 +142,24 @@ glm::vec2 Samples::GetSize()
 
 void Samples::SetColor(GLubyte paletteIndex)
 {
+  if((*samples)[activeColor] == paletteIndex) return;
+
+  // A snapshot still being saved keeps the old colors
+  if(samples.use_count() > 1) samples = std::make_shared<std::vector<GLuint>>(*samples);
+
   (*samples)[activeColor] = paletteIndex;
+
+  UpdateUniformBuffer();
+
+  // Every surface shaded from the samples changes with them
+  App::Invalidate();
+}
+
+void Samples::BindUniformBlock(GLuint programId)
+{
+  const auto blockIndex = glGetUniformBlockIndex(programId, "SampleColors");
+
+  if(blockIndex != GL_INVALID_INDEX) glUniformBlockBinding(programId, blockIndex, uniformBinding);
 }
 
 GLuint Samples::GetActiveSample()
@@ -184,17 +172,65 @@ GLuint Samples::GetActiveColor()
   return activeColor;
 }
 
+GLuint Samples::GetActiveEntry()
+{
+  // Each half holds four samples of three colors followed by the background
+  const GLuint half  = samples->size() / 2;
+  const GLuint index = activeColor % half;
+
+  return index == half - 1 ? 0 : index % 3 + 1;
+}
+
 std::shared_ptr<IDrawable> Samples::GetDrawable()
 {
   return drawable;
 }
 
-void Samples::SetSamples(std::vector<GLuint> newSamples)
+void Samples::SetSamples(std::vector<GLuint>&& newSamples)
 {
-  samples = std::make_shared<std::vector<GLuint>>(newSamples);
+  samples = std::make_shared<std::vector<GLuint>>(std::move(newSamples));
+
+  UpdateUniformBuffer();
 }
 
-std::shared_ptr<std::vector<GLuint>> Samples::GetSamples()
+View<const GLuint> Samples::GetSamples()
+{
+  return View<const GLuint>(samples->data(), samples->size());
+}
+
+std::shared_ptr<const std::vector<GLuint>> Samples::GetSnapshot()
 {
   return samples;
 }
+
+void Samples::UpdateUniformBuffer()
+{
+  if(uniformBufferId == 0) return;
+
+  // Each half holds four sub-palettes of three colors followed by the background
+  GLfloat colors[8 * 4 * 4];
+
+  for(size_t group = 0; group < 8; group++)
+  {
+    const size_t offset = group < 4 ? 0 : 13;
+
+    for(size_t entry = 0; entry < 4; entry++)
+    {
+      const auto sample = entry == 0
+        ? offset + 12
+        : offset + (group % 4) * 3 + entry - 1;
+
+      const auto index = sample < samples->size() ? (*samples)[sample] % 64 : 0;
+      const auto color = colors + (group * 4 + entry) * 4;
+
+      color[0] = Palette::paletteRGB[index * 3]     / 255.0f;
+      color[1] = Palette::paletteRGB[index * 3 + 1] / 255.0f;
+      color[2] = Palette::paletteRGB[index * 3 + 2] / 255.0f;
+      color[3] = 1.0f;
+    }
+  }
+
+  glBindBuffer(GL_UNIFORM_BUFFER, uniformBufferId);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(colors), colors);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
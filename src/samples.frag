@@ -4,7 +4,6 @@ in vec2 uv;
 
 out vec3 color;
 
-const uvec2 PALETTE_SIZE  = uvec2(16u, 4u);
 const uint  SAMPLES_SIZE  = 26u;
 const uint  SAMPLE_GROUPS = 8u;
 const vec2  PART          = vec2(1.0 / (SAMPLES_SIZE / 2.0), 0.5);
@@ -14,8 +13,11 @@ const vec3  HOVER_B_COLOR = vec3(1.0, 1.0, 0.0);
 const vec3  AS_B_COLOR    = vec3(1.0, 0.0, 1.0);
 const vec3  AC_B_COLOR    = vec3(0.0, 1.0, 1.0);
 
-uniform uint      samples[SAMPLES_SIZE];
-uniform sampler2D paletteTexture;
+layout(std140) uniform SampleColors
+{
+    vec4 sampleColors[SAMPLE_GROUPS * 4u];
+};
+
 uniform vec2      mouse;
 uniform uint      activeSample;
 uniform uint      activeColor;
@@ -65,17 +67,13 @@ bool onAcBorder =
          || abs(acBottom - uv.y) < B_SIZE.y * B_FACTOR
           );
 
-uint offset       = uint(uv.y <= 0.5 ? SAMPLES_SIZE / 2.0 : 0);
-uint sampleIndex  = uint(offset + uv.x * float(SAMPLES_SIZE / 2.0));
-uint paletteIndex = samples[sampleIndex];
+// Every fourth color of a sub-palette is the background of its half
+uint side   = uv.y <= 0.5 ? 1u : 0u;
+uint cell   = min(uint(uv.x * float(SAMPLES_SIZE / 2.0)), SAMPLES_SIZE / 2u - 1u);
+uint group  = side * 4u + (cell == 12u ? 0u : cell / 3u);
+uint entry  = cell == 12u ? 0u : cell % 3u + 1u;
 
-vec3 tColor =
-    texture(paletteTexture,
-            vec2(
-                mod(paletteIndex, PALETTE_SIZE.x)    / PALETTE_SIZE.x,
-                floor(paletteIndex / PALETTE_SIZE.x) / PALETTE_SIZE.y
-                )
-        ).xyz;
+vec3 tColor = sampleColors[group * 4u + entry].rgb;
 
 void main()
 {
@@ -14,13 +14,15 @@
 #include "palette.h"
 #include "offset.h"
 #include "idrawable.h"
+#include "quad.h"
+#include "view.h"
 
 struct SamplesDrawable;
 
 class Samples
 {
 public:
-  static AppStatus Start(GLuint textureId);
+  static AppStatus Start();
   static AppStatus Stop();
   static AppStatus Draw(glm::mat4 projection, glm::mat4 view, glm::vec2 mouse);
   
@@ -28,19 +30,26 @@ public:
   static bool Release(glm::vec2 mouse);
 
   static void SetColor(GLubyte paletteIndex);
-  static void SetSamples(std::vector<GLuint> newSamples);
+  static void BindUniformBlock(GLuint programId);
+  static void SetSamples(std::vector<GLuint>&& newSamples);
 
   static GLuint    GetActiveSample(); 
   static GLuint    GetActiveColor();
+  static GLuint    GetActiveEntry();
   static glm::vec2 GetPosition();
   static glm::vec2 GetSize();
 
   static std::shared_ptr<IDrawable> GetDrawable();
   
-  static std::shared_ptr<std::vector<GLuint>> GetSamples();
+  static View<const GLuint> GetSamples();
+
+  static std::shared_ptr<const std::vector<GLuint>> GetSnapshot();
 
 private:
+  static void UpdateUniformBuffer();
+
   static const glm::vec2 size;
+  static const GLuint    uniformBinding;
   
   static glm::vec3 position;
   static glm::mat4 model;
@@ -49,18 +58,13 @@ private:
   static GLuint activeColor;
   
   static GLuint programId;
-  static GLuint vertexBufferId;
-  static GLuint indexBufferId;
-  static GLuint paletteTextureId;
+  static GLuint uniformBufferId;
   
   static GLint mvpUniformId;
   static GLint mouseUniformId;
-  static GLint samplesUniformId;
   static GLint activeSampleUniformId;
   static GLint activeColorUniformId;
   
-  static std::vector<GLfloat>     vertices;
-  static std::vector<GLuint>      indices;
   static std::vector<std::string> filenames;
   
   static std::shared_ptr<std::vector<GLuint>> samples;
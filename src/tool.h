@@ -10,7 +10,8 @@ enum Tool
   RectangleCheckerboard,
   EllipseFrame,
   EllipseFill,
-  Fill
+  Fill,
+  Select
 };
 
 #endif
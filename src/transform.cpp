@@ -0,0 +1,281 @@
+#include "transform.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "codec.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TRANSFORM_X86
+#endif
+
+// Plane words hold row 0 in the lowest byte and the leftmost pixel in bit 7 of its row
+
+// Every byte with its bits in reverse order
+static GLubyte reversed[256];
+
+Transform::Transformer Transform::transformer;
+Transform::Remapper    Transform::remapper;
+std::string            Transform::backend;
+
+// Swaps bit (row, column) with bit (column, row) counting from the lowest bit
+static uint64_t Transpose(uint64_t x)
+{
+  uint64_t t;
+
+  t  = 0x0f0f0f0f00000000ull & (x ^ (x << 28));
+  x ^= t ^ (t >> 28);
+  t  = 0x3333000033330000ull & (x ^ (x << 14));
+  x ^= t ^ (t >> 14);
+  t  = 0x5500550055005500ull & (x ^ (x << 7));
+  x ^= t ^ (t >> 7);
+
+  return x;
+}
+
+static uint64_t Mirror(uint64_t x)
+{
+  uint64_t result = 0;
+
+  for(size_t row = 0; row < 8; row++)
+  {
+    result |= (uint64_t)reversed[(x >> (row * 8)) & 0xff] << (row * 8);
+  }
+
+  return result;
+}
+
+static uint64_t TransformPlane(TileTransform transform, uint64_t x)
+{
+  // The bit transpose turns the tile about its other diagonal, a flip finishes the rotation
+  switch(transform)
+  {
+    case TileTransform::FlipHorizontal:         return Mirror(x);
+    case TileTransform::FlipVertical:           return __builtin_bswap64(x);
+    case TileTransform::RotateClockwise:        return __builtin_bswap64(Transpose(x));
+    case TileTransform::RotateCounterClockwise: return Mirror(Transpose(x));
+  }
+
+  return x;
+}
+
+// Every bit of the word set where the entry goes to a color with that plane bit
+static uint64_t PlaneMask(const std::array<GLubyte, 4>& entries, size_t entry, size_t plane)
+{
+  return (entries[entry] >> plane) & 1 ? ~0ull : 0ull;
+}
+
+static void TransformTilesScalar(TileTransform transform, GLubyte* planar, size_t count)
+{
+  for(size_t plane = 0; plane < count * 2; plane++, planar += 8)
+  {
+    uint64_t x;
+    memcpy(&x, planar, 8);
+
+    x = TransformPlane(transform, x);
+
+    memcpy(planar, &x, 8);
+  }
+}
+
+static void RemapTilesScalar(const std::array<GLubyte, 4>& entries, GLubyte* planar, size_t count)
+{
+  uint64_t selectLow[4];
+  uint64_t selectHigh[4];
+
+  for(size_t i = 0; i < 4; i++)
+  {
+    selectLow[i]  = PlaneMask(entries, i, 0);
+    selectHigh[i] = PlaneMask(entries, i, 1);
+  }
+
+  for(size_t tile = 0; tile < count; tile++, planar += Codec::TILE_BYTES)
+  {
+    uint64_t low;
+    uint64_t high;
+
+    memcpy(&low, planar, 8);
+    memcpy(&high, planar + 8, 8);
+
+    // Where each of the four entries is
+    const uint64_t is[] = { ~low & ~high, low & ~high, ~low & high, low & high };
+
+    uint64_t newLow  = 0;
+    uint64_t newHigh = 0;
+
+    for(size_t i = 0; i < 4; i++)
+    {
+      newLow  |= is[i] & selectLow[i];
+      newHigh |= is[i] & selectHigh[i];
+    }
+
+    memcpy(planar, &newLow, 8);
+    memcpy(planar + 8, &newHigh, 8);
+  }
+}
+
+#ifdef TRANSFORM_X86
+
+__attribute__((target("avx2")))
+static __m256i TransposeAVX2(__m256i x)
+{
+  const __m256i k4 = _mm256_set1_epi64x(0x0f0f0f0f00000000ll);
+  const __m256i k2 = _mm256_set1_epi64x(0x3333000033330000ll);
+  const __m256i k1 = _mm256_set1_epi64x(0x5500550055005500ll);
+
+  __m256i t;
+
+  t = _mm256_and_si256(k4, _mm256_xor_si256(x, _mm256_slli_epi64(x, 28)));
+  x = _mm256_xor_si256(x, _mm256_xor_si256(t, _mm256_srli_epi64(t, 28)));
+  t = _mm256_and_si256(k2, _mm256_xor_si256(x, _mm256_slli_epi64(x, 14)));
+  x = _mm256_xor_si256(x, _mm256_xor_si256(t, _mm256_srli_epi64(t, 14)));
+  t = _mm256_and_si256(k1, _mm256_xor_si256(x, _mm256_slli_epi64(x, 7)));
+  x = _mm256_xor_si256(x, _mm256_xor_si256(t, _mm256_srli_epi64(t, 7)));
+
+  return x;
+}
+
+__attribute__((target("avx2")))
+static __m256i MirrorAVX2(__m256i x)
+{
+  // Both nibbles of every byte are reversed through a 16 entry table and swapped
+  const __m256i table = _mm256_setr_epi8
+    ( 0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf
+    , 0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf
+    );
+
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+  const __m256i low  = _mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble));
+  const __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+
+  return _mm256_or_si256(_mm256_slli_epi16(low, 4), high);
+}
+
+__attribute__((target("avx2")))
+static __m256i SwapRowsAVX2(__m256i x)
+{
+  const __m256i reverse = _mm256_setr_epi8
+    ( 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+    , 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+    );
+
+  return _mm256_shuffle_epi8(x, reverse);
+}
+
+__attribute__((target("avx2")))
+static void TransformTilesAVX2(TileTransform transform, GLubyte* planar, size_t count)
+{
+  size_t tile = 0;
+
+  // Two tiles, four planes, per register
+  for(; tile + 2 <= count; tile += 2, planar += Codec::TILE_BYTES * 2)
+  {
+    __m256i x = _mm256_loadu_si256((const __m256i*)planar);
+
+    switch(transform)
+    {
+      case TileTransform::FlipHorizontal:         x = MirrorAVX2(x);                   break;
+      case TileTransform::FlipVertical:           x = SwapRowsAVX2(x);                 break;
+      case TileTransform::RotateClockwise:        x = SwapRowsAVX2(TransposeAVX2(x));  break;
+      case TileTransform::RotateCounterClockwise: x = MirrorAVX2(TransposeAVX2(x));    break;
+    }
+
+    _mm256_storeu_si256((__m256i*)planar, x);
+  }
+
+  TransformTilesScalar(transform, planar, count - tile);
+}
+
+__attribute__((target("avx2")))
+static void RemapTilesAVX2(const std::array<GLubyte, 4>& entries, GLubyte* planar, size_t count)
+{
+  // Lanes alternate low and high planes, so each lane picks the plane bit it holds
+  __m256i select[4];
+
+  for(size_t i = 0; i < 4; i++)
+  {
+    const long long low  = PlaneMask(entries, i, 0);
+    const long long high = PlaneMask(entries, i, 1);
+
+    select[i] = _mm256_setr_epi64x(low, high, low, high);
+  }
+
+  size_t tile = 0;
+
+  for(; tile + 2 <= count; tile += 2, planar += Codec::TILE_BYTES * 2)
+  {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)planar);
+
+    // Every lane sees the low and the high plane of its own tile
+    const __m256i low  = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 2, 0, 0));
+    const __m256i high = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 1, 1));
+
+    const __m256i is[] =
+      { _mm256_andnot_si256(_mm256_or_si256(low, high), _mm256_set1_epi8(-1))
+      , _mm256_andnot_si256(high, low)
+      , _mm256_andnot_si256(low, high)
+      , _mm256_and_si256(low, high)
+      };
+
+    __m256i result = _mm256_setzero_si256();
+
+    for(size_t i = 0; i < 4; i++) result = _mm256_or_si256(result, _mm256_and_si256(is[i], select[i]));
+
+    _mm256_storeu_si256((__m256i*)planar, result);
+  }
+
+  RemapTilesScalar(entries, planar, count - tile);
+}
+
+#endif
+
+AppStatus Transform::Start()
+{
+  for(uint32_t b = 0; b < 256; b++)
+  {
+    GLubyte r = 0;
+
+    for(uint32_t bit = 0; bit < 8; bit++)
+    {
+      r |= ((b >> bit) & 1) << (7 - bit);
+    }
+
+    reversed[b] = r;
+  }
+
+  transformer = TransformTilesScalar;
+  remapper    = RemapTilesScalar;
+  backend     = "scalar";
+
+#ifdef TRANSFORM_X86
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx2"))
+  {
+    transformer = TransformTilesAVX2;
+    remapper    = RemapTilesAVX2;
+    backend     = "AVX2";
+  }
+#endif
+
+  Debug::Log(LogLevel::Info, "Using " + backend + " tile transforms");
+
+  return AppStatus::Success;
+}
+
+void Transform::Apply(TileTransform transform, GLubyte* planar, size_t count)
+{
+  transformer(transform, planar, count);
+}
+
+void Transform::Remap(const std::array<GLubyte, 4>& entries, GLubyte* planar, size_t count)
+{
+  remapper(entries, planar, count);
+}
+
+std::string Transform::GetBackend()
+{
+  return backend;
+}
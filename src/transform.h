@@ -0,0 +1,50 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <GL/glew.h>
+#include <array>
+#include <string>
+#include <cstddef>
+
+#include "appstatus.h"
+#include "debug.h"
+
+enum TileTransform
+{
+  FlipHorizontal = 0,
+  FlipVertical,
+  RotateClockwise,
+  RotateCounterClockwise
+};
+
+/*
+  Transforms planar tiles in place, each tile on its own like the PPU flips
+  sprites.
+
+  A plane of a tile is one 64-bit word, so a flip or a rotation is a few
+  shifts and masks per plane and a color remap is a few boolean ops on
+  both planes. Whole banks go through in one call, two tiles per register
+  when AVX2 is there.
+*/
+class Transform
+{
+public:
+  static AppStatus Start();
+
+  static void Apply(TileTransform transform, GLubyte* planar, size_t count);
+
+  // Entry i of the tiles becomes entries[i]
+  static void Remap(const std::array<GLubyte, 4>& entries, GLubyte* planar, size_t count);
+
+  static std::string GetBackend();
+
+private:
+  typedef void (*Transformer)(TileTransform, GLubyte*, size_t);
+  typedef void (*Remapper)(const std::array<GLubyte, 4>&, GLubyte*, size_t);
+
+  static Transformer transformer;
+  static Remapper    remapper;
+  static std::string backend;
+};
+
+#endif
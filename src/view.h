@@ -0,0 +1,39 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include <cstddef>
+
+/*
+  Non-owning view of contiguous elements, valid as long as the storage it
+  was taken from. Meant for readers within a frame, readers that keep the
+  data around take a snapshot instead.
+*/
+template <typename T>
+class View
+{
+public:
+  View() : first(nullptr), count(0) {}
+  View(T* data, size_t size) : first(data), count(size) {}
+
+  template <typename Container>
+  View(Container& container) : first(container.data()), count(container.size()) {}
+
+  T*     data()  const { return first; }
+  size_t size()  const { return count; }
+  bool   empty() const { return count == 0; }
+  T*     begin() const { return first; }
+  T*     end()   const { return first + count; }
+
+  T& operator[](size_t i) const { return first[i]; }
+
+  View Slice(size_t offset, size_t length) const
+  {
+    return View(first + offset, length);
+  }
+
+private:
+  T*     first;
+  size_t count;
+};
+
+#endif
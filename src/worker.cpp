@@ -0,0 +1,89 @@
+#include "worker.h"
+
+std::thread             Worker::thread;
+std::mutex              Worker::mutex;
+std::condition_variable Worker::condition;
+std::deque<Worker::Job> Worker::jobs;
+std::deque<Worker::Completion> Worker::completions;
+bool                    Worker::stopping = false;
+
+AppStatus Worker::Start()
+{
+  stopping = false;
+  thread   = std::thread(Run);
+
+  return AppStatus::Success;
+}
+
+AppStatus Worker::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  condition.notify_one();
+
+  // Pending jobs are finished first so no save is lost on exit
+  if(thread.joinable()) thread.join();
+
+  Poll();
+
+  return AppStatus::Success;
+}
+
+void Worker::Post(Job job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(job);
+  }
+
+  condition.notify_one();
+}
+
+bool Worker::Poll()
+{
+  std::deque<Completion> finished;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finished.swap(completions);
+  }
+
+  for(const auto& x : finished)
+  {
+    if(x) x();
+  }
+
+  return !finished.empty();
+}
+
+void Worker::Run()
+{
+  while(true)
+  {
+    Job job;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      condition.wait(lock, []() -> bool { return stopping || !jobs.empty(); });
+
+      if(jobs.empty()) return;
+
+      job = jobs.front();
+      jobs.pop_front();
+    }
+
+    const auto completion = job();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      completions.push_back(completion);
+    }
+
+    // Wake the main loop so the completion is picked up right away
+    glfwPostEmptyEvent();
+  }
+}
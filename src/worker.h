@@ -0,0 +1,42 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <GLFW/glfw3.h>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+#include "appstatus.h"
+
+/*
+  Runs file I/O on a background thread, one job at a time in posting order.
+
+  A job only works on data it captured when it was posted and returns a
+  completion, which runs on the main thread during the next Poll.
+*/
+class Worker
+{
+public:
+  typedef std::function<void()>       Completion;
+  typedef std::function<Completion()> Job;
+
+  static AppStatus Start();
+  static AppStatus Stop();
+
+  static void Post(Job job);
+  static bool Poll();
+
+private:
+  static void Run();
+
+  static std::thread             thread;
+  static std::mutex              mutex;
+  static std::condition_variable condition;
+  static std::deque<Job>         jobs;
+  static std::deque<Completion>  completions;
+  static bool                    stopping;
+};
+
+#endif